@@ -0,0 +1,178 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "ConsoleBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace pc;
+
+using namespace std;
+
+ConsoleBuffer::ConsoleBuffer(size_t bytes, size_t lines) :
+m_data(max<size_t>(bytes, 1)),
+m_head(0),
+m_size(0),
+m_lines(max<size_t>(lines, 1)),
+m_firstLine(0),
+m_lineCount(0),
+m_pending(0),
+m_appended(0),
+m_dropped(0),
+m_flushedAppended(0),
+m_flushedDropped(0),
+m_shown(0)
+{
+}
+
+void ConsoleBuffer::Append(string_view text)
+{
+	size_t capacity = m_data.size();
+	
+	while (text.size() > 0) {
+		size_t nl = text.find('\n');
+		size_t count = (nl == string_view::npos) ? text.size() : nl + 1;
+		string_view chunk = text.substr(0, count);
+		text.remove_prefix(count);
+		
+		//only the tail of a chunk larger than the whole buffer survives
+		if (chunk.size() > capacity) {
+			DropBytes(m_size);
+			m_appended += chunk.size() - capacity;
+			m_dropped += chunk.size() - capacity;
+			chunk.remove_prefix(chunk.size() - capacity);
+		}
+		
+		while (m_size + chunk.size() > capacity) {
+			DropLine();
+		}
+		
+		Write(chunk.data(), chunk.size());
+		m_pending += chunk.size();
+		
+		if (chunk.back() == '\n') {
+			if (m_lineCount == m_lines.size()) {
+				DropLine();
+			}
+			
+			m_lines[(m_firstLine + m_lineCount) % m_lines.size()] = m_pending;
+			m_lineCount++;
+			m_pending = 0;
+		}
+	}
+}
+
+void ConsoleBuffer::Clear()
+{
+	DropBytes(m_size);
+	m_head = 0;
+}
+
+string ConsoleBuffer::Text() const
+{
+	string text;
+	text.reserve(m_size);
+	
+	size_t first = min(m_size, m_data.size() - m_head);
+	text.append(m_data.data() + m_head, first);
+	text.append(m_data.data(), m_size - first);
+	
+	return text;
+}
+
+bool ConsoleBuffer::Flush(size_t& dropped, string& appended)
+{
+	if (m_appended == m_flushedAppended and m_dropped == m_flushedDropped) {
+		return false;
+	}
+	
+	//when more was dropped than shown, the view starts over
+	dropped = min<uint64_t>(m_dropped - m_flushedDropped, m_shown);
+	size_t kept = m_shown - dropped;
+	size_t count = m_size - kept;
+	
+	appended.clear();
+	appended.reserve(count);
+	
+	size_t start = (m_head + kept) % m_data.size();
+	size_t first = min(count, m_data.size() - start);
+	appended.append(m_data.data() + start, first);
+	appended.append(m_data.data(), count - first);
+	
+	m_flushedAppended = m_appended;
+	m_flushedDropped = m_dropped;
+	m_shown = m_size;
+	
+	return true;
+}
+
+void ConsoleBuffer::DropLine()
+{
+	if (m_lineCount > 0) {
+		DropBytes(m_lines[m_firstLine]);
+		return;
+	}
+	
+	//a single unfinished line filling everything loses its start
+	DropBytes(m_size);
+}
+
+void ConsoleBuffer::DropBytes(size_t count)
+{
+	count = min(count, m_size);
+	
+	m_head = (m_head + count) % m_data.size();
+	m_size -= count;
+	m_dropped += count;
+	
+	//dropped bytes are whole leading lines, maybe followed by the unfinished one
+	while (count > 0 and m_lineCount > 0) {
+		uint32_t& length = m_lines[m_firstLine];
+		
+		if (count < length) {
+			length -= count;
+			return;
+		}
+		
+		count -= length;
+		m_firstLine = (m_firstLine + 1) % m_lines.size();
+		m_lineCount--;
+	}
+	
+	m_pending -= min(count, m_pending);
+}
+
+void ConsoleBuffer::Write(const char* data, size_t count)
+{
+	size_t capacity = m_data.size();
+	size_t tail = (m_head + m_size) % capacity;
+	size_t first = min(count, capacity - tail);
+	
+	memcpy(m_data.data() + tail, data, first);
+	memcpy(m_data.data(), data + first, count - first);
+	
+	m_size += count;
+	m_appended += count;
+}
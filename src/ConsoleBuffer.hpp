@@ -0,0 +1,98 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_CONSOLE_BUFFER
+#define PC_CONSOLE_BUFFER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pc
+{
+	/*
+		Console text bounded in bytes and lines, oldest lines are dropped.
+		Changes are collected so a text view can follow with one delete at
+		its start and one insert at its end
+	*/
+	class ConsoleBuffer
+	{
+		public:
+		
+		ConsoleBuffer(size_t bytes, size_t lines);
+		
+		void Append(std::string_view text);
+		void Clear();
+		
+		size_t Bytes() const
+		{
+			return m_size;
+		}
+		
+		// an unfinished last line counts too
+		size_t Lines() const
+		{
+			return m_lineCount + (m_pending > 0 ? 1 : 0);
+		}
+		
+		std::string Text() const;
+		
+		// changes since last call: first dropped bytes of the text flushed
+		// before are gone, appended goes after what is left
+		// false when nothing changed
+		bool Flush(size_t& dropped, std::string& appended);
+		
+		protected:
+		
+		void DropLine();
+		void DropBytes(size_t count);
+		void Write(const char* data, size_t count);
+		
+		// text ring
+		std::vector<char> m_data;
+		size_t m_head;
+		size_t m_size;
+		
+		// lengths of complete lines, ring
+		std::vector<uint32_t> m_lines;
+		size_t m_firstLine;
+		size_t m_lineCount;
+		
+		// bytes of the line still being written
+		size_t m_pending;
+		
+		// totals since creation
+		uint64_t m_appended;
+		uint64_t m_dropped;
+		
+		// state at last Flush
+		uint64_t m_flushedAppended;
+		uint64_t m_flushedDropped;
+		size_t m_shown;
+	};
+}
+
+#endif
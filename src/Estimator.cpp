@@ -0,0 +1,233 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Estimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	//below this a move does not become a block
+	const float MinLength = 1e-5f;
+	
+	const float MinSpeed = 0.05f;
+}
+
+MotionLimits::MotionLimits() :
+acceleration(3000.0f),
+travelAcceleration(3000.0f),
+retractAcceleration(3000.0f),
+maxFeedrate {300.0f, 300.0f, 5.0f, 25.0f},
+junctionDeviation(0.013f),
+feedrate(25.0f)
+{
+}
+
+Estimator::Estimator()
+{
+	Clear();
+}
+
+void Estimator::Clear()
+{
+	m_limits = m_defaults;
+	
+	for (int n = 0; n < Axes; n++) {
+		m_position[n] = 0.0f;
+		m_unit[n] = 0.0f;
+	}
+	
+	m_lastNominal = 0.0f;
+	
+	m_length.clear();
+	m_acceleration.clear();
+	m_nominal.clear();
+	m_junction.clear();
+	m_layer.clear();
+	
+	m_time = 0.0;
+	m_layerTimes.clear();
+}
+
+void Estimator::Reserve(size_t blocks)
+{
+	m_length.reserve(blocks);
+	m_acceleration.reserve(blocks);
+	m_nominal.reserve(blocks);
+	m_junction.reserve(blocks);
+	m_layer.reserve(blocks);
+}
+
+void Estimator::SetMaxFeedrate(int axis, float value)
+{
+	if (value > 0.0f) {
+		m_limits.maxFeedrate[axis] = value;
+	}
+}
+
+void Estimator::SetAcceleration(float print, float travel, float retract)
+{
+	if (print > 0.0f) {
+		m_limits.acceleration = print;
+	}
+	
+	if (travel > 0.0f) {
+		m_limits.travelAcceleration = travel;
+	}
+	
+	if (retract > 0.0f) {
+		m_limits.retractAcceleration = retract;
+	}
+}
+
+void Estimator::Move(const float* target, float feedrate, int layer)
+{
+	float delta[Axes];
+	
+	for (int n = 0; n < Axes; n++) {
+		delta[n] = target[n] - m_position[n];
+		m_position[n] = target[n];
+	}
+	
+	float cartesian = sqrt(delta[AxisX] * delta[AxisX] + delta[AxisY] * delta[AxisY] + delta[AxisZ] * delta[AxisZ]);
+	
+	//extruder only moves are measured along the filament
+	float length = (cartesian > MinLength) ? cartesian : fabs(delta[AxisE]);
+	
+	if (length < MinLength) {
+		return;
+	}
+	
+	float acceleration = m_limits.travelAcceleration;
+	if (cartesian <= MinLength) {
+		acceleration = m_limits.retractAcceleration;
+	}
+	else if (delta[AxisE] > 0.0f) {
+		acceleration = m_limits.acceleration;
+	}
+	
+	//no axis may exceed its own max feedrate
+	float nominal = max(feedrate, MinSpeed);
+	float norm = 0.0f;
+	
+	for (int n = 0; n < Axes; n++) {
+		float distance = fabs(delta[n]);
+		
+		if (distance > 0.0f) {
+			nominal = min(nominal, m_limits.maxFeedrate[n] * length / distance);
+		}
+		
+		norm += delta[n] * delta[n];
+	}
+	
+	norm = 1.0f / sqrt(norm);
+	
+	//junction deviation, as in Grbl and Marlin
+	float junction = 0.0f;
+	float cosTheta = 0.0f;
+	float unit[Axes];
+	
+	for (int n = 0; n < Axes; n++) {
+		unit[n] = delta[n] * norm;
+		cosTheta -= m_unit[n] * unit[n];
+		m_unit[n] = unit[n];
+	}
+	
+	if (m_lastNominal > 0.0f) {
+		if (cosTheta > 0.999999f) {
+			junction = MinSpeed * MinSpeed;
+		}
+		else {
+			cosTheta = max(cosTheta, -0.999999f);
+			float sinTheta = sqrt(0.5f * (1.0f - cosTheta));
+			junction = acceleration * m_limits.junctionDeviation * sinTheta / (1.0f - sinTheta);
+		}
+		
+		junction = min(junction, min(nominal * nominal, m_lastNominal * m_lastNominal));
+	}
+	
+	m_lastNominal = nominal;
+	
+	m_length.push_back(length);
+	m_acceleration.push_back(acceleration);
+	m_nominal.push_back(nominal * nominal);
+	m_junction.push_back(junction);
+	m_layer.push_back(layer);
+}
+
+void Estimator::Estimate()
+{
+	size_t count = m_length.size();
+	
+	const float* length = m_length.data();
+	const float* acceleration = m_acceleration.data();
+	const float* nominal = m_nominal.data();
+	
+	vector<float> entry(m_junction);
+	float* v2 = entry.data();
+	
+	//backward pass, every block must be able to stop by the end of the job
+	float next = 0.0f;
+	for (size_t n = count; n-- > 0;) {
+		v2[n] = min(v2[n], next + 2.0f * acceleration[n] * length[n]);
+		next = v2[n];
+	}
+	
+	//forward pass, entry speed is bounded by what the previous block reached
+	for (size_t n = 1; n < count; n++) {
+		v2[n] = min(v2[n], v2[n - 1] + 2.0f * acceleration[n - 1] * length[n - 1]);
+	}
+	
+	//trapezoid of each block, independent of each other
+	vector<float> times(count);
+	float* t = times.data();
+	
+	for (size_t n = 0; n < count; n++) {
+		float a = acceleration[n];
+		float L = length[n];
+		float vi2 = v2[n];
+		float vo2 = (n + 1 < count) ? v2[n + 1] : 0.0f;
+		
+		//peak is below nominal when there is no room to cruise
+		float vp2 = min(nominal[n], 0.5f * (2.0f * a * L + vi2 + vo2));
+		float vp = sqrt(vp2);
+		float cruise = max(0.0f, L - (2.0f * vp2 - vi2 - vo2) / (2.0f * a));
+		
+		t[n] = (2.0f * vp - sqrt(vi2) - sqrt(vo2)) / a + cruise / vp;
+	}
+	
+	int layers = (count > 0) ? m_layer[count - 1] + 1 : 0;
+	m_layerTimes.assign(layers, 0.0f);
+	m_time = 0.0;
+	
+	for (size_t n = 0; n < count; n++) {
+		m_layerTimes[m_layer[n]] += t[n];
+		m_time += t[n];
+	}
+}
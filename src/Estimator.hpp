@@ -0,0 +1,140 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_ESTIMATOR
+#define PC_ESTIMATOR
+
+#include <cstddef>
+#include <vector>
+
+namespace pc
+{
+	enum Axis
+	{
+		AxisX = 0,
+		AxisY,
+		AxisZ,
+		AxisE,
+		Axes
+	};
+	
+	/*
+		Firmware motion settings, speeds in mm/s and accelerations in mm/s²
+	*/
+	class MotionLimits
+	{
+		public:
+		
+		MotionLimits();
+		
+		float acceleration;
+		float travelAcceleration;
+		float retractAcceleration;
+		float maxFeedrate[Axes];
+		float junctionDeviation;
+		
+		// used until the file sets one
+		float feedrate;
+	};
+	
+	/*
+		Print time from replaying moves through a trapezoidal planner with
+		junction deviation. Blocks are kept as columns for the planner passes
+	*/
+	class Estimator
+	{
+		public:
+		
+		Estimator();
+		
+		// limits at the start of every file
+		void SetLimits(const MotionLimits& limits)
+		{
+			m_defaults = limits;
+		}
+		
+		const MotionLimits& Limits() const
+		{
+			return m_defaults;
+		}
+		
+		void Clear();
+		
+		void Reserve(size_t blocks);
+		
+		// absolute target in mm, feedrate in mm/s
+		void Move(const float* target, float feedrate, int layer);
+		
+		void SetPosition(int axis, float value)
+		{
+			m_position[axis] = value;
+		}
+		
+		void SetMaxFeedrate(int axis, float value);
+		void SetAcceleration(float print, float travel, float retract);
+		
+		// runs the planner over every block added so far
+		void Estimate();
+		
+		// seconds
+		double Time() const
+		{
+			return m_time;
+		}
+		
+		// seconds per layer, indexed as render layers
+		const std::vector<float>& LayerTimes() const
+		{
+			return m_layerTimes;
+		}
+		
+		int Blocks() const
+		{
+			return m_length.size();
+		}
+		
+		protected:
+		
+		friend class PreviewCache;
+		
+		MotionLimits m_defaults;
+		MotionLimits m_limits;
+		
+		float m_position[Axes];
+		float m_unit[Axes];
+		float m_lastNominal;
+		
+		// one entry per block, speeds are squared
+		std::vector<float> m_length;
+		std::vector<float> m_acceleration;
+		std::vector<float> m_nominal;
+		std::vector<float> m_junction;
+		std::vector<int> m_layer;
+		
+		double m_time;
+		std::vector<float> m_layerTimes;
+	};
+}
+
+#endif
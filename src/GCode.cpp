@@ -25,174 +25,815 @@ SOFTWARE.
 #include "GCode.hpp"
 
 #include <iostream>
-#include <fstream>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <thread>
 #include <vector>
-#include <map>
-
 
 using namespace pc;
 
 using namespace std;
 
-vector<string> Tokens(string& line)
+namespace
 {
-	vector<string> tokens;
-	bool comment = false;
-	bool knee = false;
-	string tmp;
+	const int MaxWords = 16;
 	
-	for (char c:line ) {
-		if (c == ' ') {
-			if(knee == true) {
-				tokens.push_back(tmp);
-				tmp.clear();
-				knee = false;
-			}
+	bool IsBlank(char c)
+	{
+		return (c == ' ' or c == '\t' or c == '\r');
+	}
+}
+
+/*
+	No allocations, no exceptions
+*/
+int pc::ScanWords(string_view line, Word* words, int max)
+{
+	const char* p = line.data();
+	const char* end = p + line.size();
+	int count = 0;
+	
+	while (p < end and count < max) {
+		char c = *p;
+		
+		if (IsBlank(c)) {
+			p++;
+			continue;
+		}
+		
+		if (c == ';') {
+			break;
+		}
+		
+		if (c >= 'a' and c <= 'z') {
+			c = c - 'a' + 'A';
+		}
+		
+		p++;
+		
+		if (c < 'A' or c > 'Z') {
+			continue;
+		}
+		
+		//from_chars does not accept a leading '+'
+		if (p < end and *p == '+') {
+			p++;
+		}
+		
+		//no exponents in G-code, G1X10E0.5 is X10 and E0.5
+		float value;
+		from_chars_result result = from_chars(p, end, value, chars_format::fixed);
+		
+		if (result.ec == errc()) {
+			words[count].letter = c;
+			words[count].value = value;
+			count++;
+			p = result.ptr;
 		}
 		else {
-			if (c == ';') {
-				comment = true;
-				break;
+			while (p < end and !IsBlank(*p) and *p != ';') {
+				p++;
 			}
-			knee=true;
-			tmp.push_back(c);
 		}
 	}
 	
-	if (knee) {
-		tokens.push_back(tmp);
-	}
-	
-	return tokens;
+	return count;
 }
 
-bool Value(string& token,char& name,float& value)
+namespace
 {
-	if (token.size()<2) {
-		return false;
-	}
+	//minimum amount of bytes handed to a parser thread
+	const size_t MinChunkSize = 1 << 20;
 	
-	name = token[0];
+	//bit n stands for axis n
+	enum MoveMask : uint8_t
+	{
+		MaskX = 1,
+		MaskY = 2,
+		MaskZ = 4,
+		MaskE = 8,
+		MaskF = 16,
+		MaskI = 32,
+		MaskJ = 64,
+		MaskR = 128
+	};
 	
-	if (name<'A' or name>'Z') {
-		return false;
-	}
+	//order matches Interpreter handlers
+	enum MoveCode : uint8_t
+	{
+		Rapid,
+		Linear,
+		ArcCW,
+		ArcCCW,
+		Home,
+		Absolute,
+		Relative,
+		SetPosition,
+		AbsoluteE,
+		RelativeE,
+		MaxFeedrate,
+		Acceleration,
+		Unknown
+	};
 	
-	try {
-		string tmp = token.substr(1);
-		value = std::stof(tmp);
-	}
-	catch(std::exception& e) {
-		return false;
-	}
+	const int GCommands = 100;
+	const int MCommands = 256;
 	
-	return true;
-}
-
-GCode::GCode()
-{
-}
-
-void GCode::LoadFile(const char* filename)
-{
-	Reset();
+	constexpr array<uint8_t, GCommands> MakeGTable()
+	{
+		array<uint8_t, GCommands> table {};
+		for (uint8_t& code : table) {
+			code = Unknown;
+		}
+		
+		table[0] = Rapid;
+		table[1] = Linear;
+		table[2] = ArcCW;
+		table[3] = ArcCCW;
+		table[28] = Home;
+		table[90] = Absolute;
+		table[91] = Relative;
+		table[92] = SetPosition;
+		
+		return table;
+	}
 	
-	int G1 = 0;
-	float X = 0.0f;
-	float Y = 0.0f;
-	float Z = 0.0f;
-	float E = 0.0f;
+	constexpr array<uint8_t, MCommands> MakeMTable()
+	{
+		array<uint8_t, MCommands> table {};
+		for (uint8_t& code : table) {
+			code = Unknown;
+		}
+		
+		table[82] = AbsoluteE;
+		table[83] = RelativeE;
+		table[203] = MaxFeedrate;
+		table[204] = Acceleration;
+		
+		return table;
+	}
 	
-	float LX = X;
-	float LY = Y;
-	float LZ = Z;
-	float LE = E;
+	constexpr array<uint8_t, GCommands> GTable = MakeGTable();
+	constexpr array<uint8_t, MCommands> MTable = MakeMTable();
 	
-	float current_layer_z = Z;
-	m_layers = 0;
+	uint8_t Classify(const Word& word)
+	{
+		int number = (int)word.value;
+		
+		//G1.5 and friends are not ours
+		if (number != word.value or number < 0) {
+			return Unknown;
+		}
+		
+		if (word.letter == 'G' and number < GCommands) {
+			return GTable[number];
+		}
+		
+		if (word.letter == 'M' and number < MCommands) {
+			return MTable[number];
+		}
+		
+		return Unknown;
+	}
 	
-	Layer layer;
+	// tokenized command, before modal state is applied
+	// M204 keeps P, T and R in x, y and z
+	struct Move
+	{
+		int line;
+		uint8_t code;
+		uint8_t mask;
+		float x;
+		float y;
+		float z;
+		float e;
+		float f;
+		float i;
+		float j;
+		float r;
+	};
 	
-	ifstream file(filename);
-	string line;
+	struct Chunk
+	{
+		size_t begin;
+		size_t end;
+		int firstLine;
+		int lines;
+		vector<Move> moves;
+	};
 	
-	while(file.good()) {
-		std::getline(file,line);
+	int CountLines(const char* data, size_t begin, size_t end)
+	{
+		int count = 0;
+		const char* p = data + begin;
+		const char* last = data + end;
 		
-		m_lines.push_back(line);
+		while ((p = (const char*)memchr(p, '\n', last - p))) {
+			count++;
+			p++;
+		}
 		
-		vector<string> tokens = Tokens(line);
+		//unterminated last line
+		if (end > begin and data[end - 1] != '\n') {
+			count++;
+		}
+		
+		return count;
+	}
+	
+	void ParseChunk(const char* data, size_t* index, Chunk& chunk)
+	{
+		Word words[MaxWords];
+		size_t start = chunk.begin;
+		int line = chunk.firstLine;
 		
-		if (tokens.size() > 0) {
-			string& token = tokens[0];
+		chunk.moves.reserve(chunk.lines);
+		
+		while (start < chunk.end) {
+			index[line] = start;
+			
+			const char* nl = (const char*)memchr(data + start, '\n', chunk.end - start);
+			size_t end = nl ? (nl - data) : chunk.end;
+			
+			int count = ScanWords(string_view(data + start, end - start), words, MaxWords);
+			
+			Move move;
 			
-			if (token == "G1") {
-				G1++;
-				for (size_t n=1;n<tokens.size();n++) {
-					char name;
-					float value;
+			if (count > 0 and (move.code = Classify(words[0])) != Unknown) {
+				move.line = line;
+				move.mask = 0;
+				
+				for (int n = 1; n < count; n++) {
+					float value = words[n].value;
+					char letter = words[n].letter;
 					
-					if (Value(tokens[n],name,value)) {
-						switch (name) {
-							case 'X':
-								LX = X;
-								X = value;
+					if (move.code == Acceleration) {
+						switch (letter) {
+							case 'S':
+								move.mask |= MaskX | MaskY;
+								move.x = value;
+								move.y = value;
 							break;
 							
-							case 'Y':
-								LY = Y;
-								Y = value;
+							case 'P':
+								move.mask |= MaskX;
+								move.x = value;
 							break;
 							
-							case 'Z':
-								LZ = Z;
-								Z = value;
-								
-								if (Z > current_layer_z) {
-									current_layer_z = Z;
-									m_layers++;
-									clog<<"stored layer:"<<m_layers-1<<endl;
-									fRender.layers.push_back(layer);
-									layer.Clear();
-									layer.z = Z;
-								}
-								
-								if (Z > m_height) {
-									m_height = Z;
-								}
+							case 'T':
+								move.mask |= MaskY;
+								move.y = value;
 							break;
 							
-							case 'E':
-								LE = E;
-								E = value;
-								if (E>0) {
-									m_filament += E;
-								}
+							case 'R':
+								move.mask |= MaskZ;
+								move.z = value;
 							break;
 						}
+						continue;
+					}
+					
+					switch (letter) {
+						case 'X':
+							move.mask |= MaskX;
+							move.x = value;
+						break;
+						
+						case 'Y':
+							move.mask |= MaskY;
+							move.y = value;
+						break;
+						
+						case 'Z':
+							move.mask |= MaskZ;
+							move.z = value;
+						break;
+						
+						case 'E':
+							move.mask |= MaskE;
+							move.e = value;
+						break;
+						
+						case 'F':
+							move.mask |= MaskF;
+							move.f = value;
+						break;
+						
+						case 'I':
+							move.mask |= MaskI;
+							move.i = value;
+						break;
+						
+						case 'J':
+							move.mask |= MaskJ;
+							move.j = value;
+						break;
+						
+						case 'R':
+							move.mask |= MaskR;
+							move.r = value;
+						break;
 					}
 				}
 				
-				//store G1 Line
-				Segment g1;
-				g1.line = m_lines.size(); //not matching Gcode N number
-				g1.start = BPoint(LX,LY);
-				g1.end = BPoint(X,Y);
-				if (E > LE) {
-					g1.type = SegmentType::Fill;
+				chunk.moves.push_back(move);
+			}
+			
+			start = end + 1;
+			line++;
+		}
+	}
+	
+	template <typename F>
+	void RunChunks(vector<Chunk>& chunks, F func)
+	{
+		vector<thread> workers;
+		
+		for (size_t n = 1; n < chunks.size(); n++) {
+			workers.emplace_back(func, std::ref(chunks[n]));
+		}
+		
+		//calling thread takes the first chunk
+		func(chunks[0]);
+		
+		for (thread& worker : workers) {
+			worker.join();
+		}
+	}
+	
+	/*
+		Applies modal state to tokenized commands in file order, building
+		the render and feeding the estimator
+	*/
+	class Interpreter
+	{
+		public:
+		
+		Interpreter(GRender& render, Estimator& estimator, float tolerance) :
+		height(0.0f),
+		filament(0.0f),
+		m_render(render),
+		m_estimator(estimator),
+		m_tolerance(tolerance),
+		m_absolute(true),
+		m_absoluteE(true),
+		m_position {0.0f, 0.0f, 0.0f, 0.0f},
+		m_offset {0.0f, 0.0f, 0.0f, 0.0f},
+		m_extruded(0.0f),
+		m_feedrate(estimator.Limits().feedrate),
+		m_layerZ(0.0f),
+		m_layerFill(false)
+		{
+		}
+		
+		void Run(const Move& move)
+		{
+			(this->*Handlers[move.code])(move);
+		}
+		
+		// highest extruding z, net extruded length
+		float height;
+		float filament;
+		
+		protected:
+		
+		typedef void (Interpreter::*Handler)(const Move& move);
+		static const Handler Handlers[Unknown];
+		
+		void Line(const Move& move)
+		{
+			float target[Axes];
+			Target(move, target);
+			LineTo(target, move.line);
+		}
+		
+		void Clockwise(const Move& move)
+		{
+			Arc(move, true);
+		}
+		
+		void CounterClockwise(const Move& move)
+		{
+			Arc(move, false);
+		}
+		
+		void Homing(const Move& move)
+		{
+			//no axis given means all of them
+			uint8_t mask = (move.mask & (MaskX | MaskY | MaskZ));
+			if (mask == 0) {
+				mask = MaskX | MaskY | MaskZ;
+			}
+			
+			for (int n = AxisX; n <= AxisZ; n++) {
+				if (mask & (1 << n)) {
+					m_position[n] = -m_offset[n];
+					m_estimator.SetPosition(n, 0.0f);
+				}
+			}
+		}
+		
+		void SetAbsolute(const Move&)
+		{
+			m_absolute = true;
+			m_absoluteE = true;
+		}
+		
+		void SetRelative(const Move&)
+		{
+			m_absolute = false;
+			m_absoluteE = false;
+		}
+		
+		void SetAbsoluteE(const Move&)
+		{
+			m_absoluteE = true;
+		}
+		
+		void SetRelativeE(const Move&)
+		{
+			m_absoluteE = false;
+		}
+		
+		// machine position stays, coordinates are shifted
+		void SetOrigin(const Move& move)
+		{
+			const float values[Axes] = {move.x, move.y, move.z, move.e};
+			
+			for (int n = 0; n < Axes; n++) {
+				if (move.mask & (1 << n)) {
+					m_offset[n] += m_position[n] - values[n];
+					m_position[n] = values[n];
+				}
+			}
+		}
+		
+		void SetMaxFeedrate(const Move& move)
+		{
+			const float values[Axes] = {move.x, move.y, move.z, move.e};
+			
+			for (int n = 0; n < Axes; n++) {
+				if (move.mask & (1 << n)) {
+					m_estimator.SetMaxFeedrate(n, values[n]);
+				}
+			}
+		}
+		
+		void SetAcceleration(const Move& move)
+		{
+			m_estimator.SetAcceleration(
+				(move.mask & MaskX) ? move.x : 0.0f,
+				(move.mask & MaskY) ? move.y : 0.0f,
+				(move.mask & MaskZ) ? move.z : 0.0f);
+		}
+		
+		void Target(const Move& move, float* target)
+		{
+			const float values[Axes] = {move.x, move.y, move.z, move.e};
+			
+			for (int n = 0; n < Axes; n++) {
+				bool absolute = (n == AxisE) ? m_absoluteE : m_absolute;
+				target[n] = m_position[n];
+				
+				if (move.mask & (1 << n)) {
+					target[n] = absolute ? values[n] : target[n] + values[n];
+				}
+			}
+			
+			if ((move.mask & MaskF) and move.f > 0.0f) {
+				m_feedrate = move.f / 60.0f;
+			}
+		}
+		
+		void LineTo(const float* target, int line)
+		{
+			float sx = m_position[AxisX] + m_offset[AxisX];
+			float sy = m_position[AxisY] + m_offset[AxisY];
+			float ex = target[AxisX] + m_offset[AxisX];
+			float ey = target[AxisY] + m_offset[AxisY];
+			float z = target[AxisZ] + m_offset[AxisZ];
+			float de = target[AxisE] - m_position[AxisE];
+			
+			bool planar = (sx != ex or sy != ey);
+			bool fill = (planar and de > 0.0f);
+			
+			//layers start where extrusion goes up, so z hops stay out
+			if (fill and z > m_layerZ + 0.0001f) {
+				m_layerZ = z;
+				
+				//a layer with travel only is taken over
+				if (m_layerFill or m_render.Layers() == 0) {
+					m_render.AddLayer(z);
 				}
 				else {
-					g1.type = SegmentType::Fly;
+					m_render.SetLayerZ(m_render.Layers() - 1, z);
 				}
-				layer.segments.push_back(g1);
+				
+				m_layerFill = false;
+			}
+			
+			if (planar) {
+				if (m_render.Layers() == 0) {
+					m_render.AddLayer(m_layerZ);
+				}
+				
+				//not matching Gcode N number
+				m_render.Add(Point(sx, sy), Point(ex, ey), fill ? SegmentType::Fill : SegmentType::Fly, line + 1);
+			}
+			
+			if (fill) {
+				m_layerFill = true;
+				height = std::max(height, z);
+			}
+			
+			filament += de;
+			m_extruded += de;
+			
+			const float machine[Axes] = {ex, ey, z, m_extruded};
+			m_estimator.Move(machine, m_feedrate, std::max(0, m_render.Layers() - 1));
+			
+			for (int n = 0; n < Axes; n++) {
+				m_position[n] = target[n];
+			}
+		}
+		
+		void Arc(const Move& move, bool clockwise)
+		{
+			float target[Axes];
+			Target(move, target);
+			
+			float sx = m_position[AxisX];
+			float sy = m_position[AxisY];
+			float ex = target[AxisX];
+			float ey = target[AxisY];
+			float cx = sx + ((move.mask & MaskI) ? move.i : 0.0f);
+			float cy = sy + ((move.mask & MaskJ) ? move.j : 0.0f);
+			
+			//radius form, center on the bisector of the chord
+			if ((move.mask & MaskR) and !(move.mask & (MaskI | MaskJ)) and (sx != ex or sy != ey)) {
+				float mx = (ex - sx) * 0.5f;
+				float my = (ey - sy) * 0.5f;
+				float half = sqrt(mx * mx + my * my);
+				float h2 = (move.r - half) * (move.r + half);
+				float h = (h2 > 0.0f) ? sqrt(h2) : 0.0f;
+				float side = (clockwise != (move.r < 0.0f)) ? -1.0f : 1.0f;
+				
+				cx = sx + mx - my / half * side * h;
+				cy = sy + my + mx / half * side * h;
+			}
+			
+			float radius = sqrt((sx - cx) * (sx - cx) + (sy - cy) * (sy - cy));
+			float start = atan2(sy - cy, sx - cx);
+			float sweep = atan2(ey - cy, ex - cx) - start;
+			
+			//same start and end is a full circle
+			if (clockwise and sweep >= 0.0f) {
+				sweep -= 2.0f * M_PI;
+			}
+			
+			if (!clockwise and sweep <= 0.0f) {
+				sweep += 2.0f * M_PI;
+			}
+			
+			//chord error stays within tolerance
+			int segments = 1;
+			if (radius > m_tolerance) {
+				float step = 2.0f * acos(1.0f - m_tolerance / radius);
+				segments = std::min((int)ceil(fabs(sweep) / step), MaxArcSegments);
+				segments = std::max(segments, 1);
 			}
+			
+			float origin[Axes];
+			for (int n = 0; n < Axes; n++) {
+				origin[n] = m_position[n];
+			}
+			
+			for (int n = 1; n < segments; n++) {
+				float t = (float)n / segments;
+				float angle = start + sweep * t;
+				float point[Axes];
+				
+				point[AxisX] = cx + radius * cos(angle);
+				point[AxisY] = cy + radius * sin(angle);
+				point[AxisZ] = origin[AxisZ] + (target[AxisZ] - origin[AxisZ]) * t;
+				point[AxisE] = origin[AxisE] + (target[AxisE] - origin[AxisE]) * t;
+				
+				LineTo(point, move.line);
+			}
+			
+			LineTo(target, move.line);
 		}
+		
+		static constexpr int MaxArcSegments = 4096;
+		
+		GRender& m_render;
+		Estimator& m_estimator;
+		float m_tolerance;
+		
+		bool m_absolute;
+		bool m_absoluteE;
+		
+		// logical coordinates, machine ones add the G92 offset
+		float m_position[Axes];
+		float m_offset[Axes];
+		float m_extruded;
+		float m_feedrate;
+		
+		float m_layerZ;
+		bool m_layerFill;
+	};
+	
+	const Interpreter::Handler Interpreter::Handlers[Unknown] = {
+		&Interpreter::Line,
+		&Interpreter::Line,
+		&Interpreter::Clockwise,
+		&Interpreter::CounterClockwise,
+		&Interpreter::Homing,
+		&Interpreter::SetAbsolute,
+		&Interpreter::SetRelative,
+		&Interpreter::SetOrigin,
+		&Interpreter::SetAbsoluteE,
+		&Interpreter::SetRelativeE,
+		&Interpreter::SetMaxFeedrate,
+		&Interpreter::SetAcceleration
+	};
+}
+
+GCode::GCode() : m_threads(0), m_arcTolerance(0.02f), m_cache(nullptr), m_fromCache(false)
+{
+	Reset();
+}
+
+void GCode::LoadFile(const char* filename)
+{
+	Reset();
+	
+	if (!m_file.Open(filename) or m_file.Size() == 0) {
+		return;
+	}
+	
+	PreviewKey key;
+	bool cached = (m_cache and m_cache->Enabled());
+	
+	if (cached) {
+		key = m_cache->Key(filename, *this);
+		
+		if (m_cache->Read(key, *this)) {
+			m_fromCache = true;
+			return;
+		}
+	}
+	
+	const char* data = m_file.Data();
+	size_t size = m_file.Size();
+	
+	int threads = m_threads;
+	if (threads <= 0) {
+		threads = std::max(1u, thread::hardware_concurrency());
+	}
+	
+	//not worth spawning threads for small files
+	threads = std::min(threads, (int)(size / MinChunkSize) + 1);
+	
+	//split at newlines, so each chunk holds whole lines
+	vector<Chunk> chunks(threads);
+	size_t begin = 0;
+	
+	for (int n = 0; n < threads; n++) {
+		size_t end = size;
+		
+		if (n < threads - 1) {
+			end = std::max(begin, (size / threads) * (n + 1));
+			const char* nl = (const char*)memchr(data + end, '\n', size - end);
+			end = nl ? (nl - data) + 1 : size;
+		}
+		
+		chunks[n].begin = begin;
+		chunks[n].end = end;
+		begin = end;
+	}
+	
+	//first pass, count lines so the index is allocated once
+	RunChunks(chunks, [data](Chunk& chunk) {
+		chunk.lines = CountLines(data, chunk.begin, chunk.end);
+	});
+	
+	int lines = 0;
+	for (Chunk& chunk : chunks) {
+		chunk.firstLine = lines;
+		lines += chunk.lines;
+	}
+	
+	m_index.resize(lines + 1);
+	m_index[lines] = size;
+	
+	//second pass, fill index and tokenize
+	size_t* index = m_index.data();
+	RunChunks(chunks, [data, index](Chunk& chunk) {
+		ParseChunk(data, index, chunk);
+	});
+	
+	size_t moves = 0;
+	for (Chunk& chunk : chunks) {
+		moves += chunk.moves.size();
+	}
+	m_estimator.Reserve(moves);
+	fRender.Reserve(moves);
+	
+	//sequential pass, carrying modal state across chunks
+	Interpreter interpreter(fRender, m_estimator, m_arcTolerance);
+	
+	for (Chunk& chunk : chunks) {
+		for (const Move& move : chunk.moves) {
+			interpreter.Run(move);
+		}
+		
+		chunk.moves.clear();
+		chunk.moves.shrink_to_fit();
 	}
+	
+	m_estimator.Estimate();
+	
+	m_layers = fRender.Layers();
+	m_height = interpreter.height;
+	m_filament = interpreter.filament;
+	
+	if (cached) {
+		m_cache->Write(key, *this);
+		m_cache->Evict();
+	}
+}
+
+void GRender::Clear()
+{
+	m_startX.clear();
+	m_startY.clear();
+	m_endX.clear();
+	m_endY.clear();
+	m_fill.clear();
+	m_line.clear();
+	m_z.clear();
+	m_first.clear();
+}
+
+void GRender::Reserve(size_t segments)
+{
+	m_startX.reserve(segments);
+	m_startY.reserve(segments);
+	m_endX.reserve(segments);
+	m_endY.reserve(segments);
+	m_fill.reserve(segments / 64 + 1);
+	m_line.reserve(segments);
+}
+
+void GRender::AddLayer(float z)
+{
+	m_z.push_back(z);
+	m_first.push_back(Segments());
+}
+
+void GRender::Add(Point start, Point end, SegmentType type, int line)
+{
+	size_t n = Segments();
+	
+	if ((n & 63) == 0) {
+		m_fill.push_back(0);
+	}
+	
+	if (type == SegmentType::Fill) {
+		m_fill.back() |= uint64_t(1) << (n & 63);
+	}
+	
+	m_startX.push_back(start.x);
+	m_startY.push_back(start.y);
+	m_endX.push_back(end.x);
+	m_endY.push_back(end.y);
+	m_line.push_back(line);
+}
+
+size_t GRender::SegmentsTo(int line) const
+{
+	return upper_bound(m_line.begin(), m_line.end(), line) - m_line.begin();
+}
+
+int GRender::LayerOf(size_t n) const
+{
+	return (int)(upper_bound(m_first.begin(), m_first.end(), n) - m_first.begin()) - 1;
 }
 
 void GCode::Reset()
 {
-	m_lines.clear();
+	m_file.Close();
+	fRender.Clear();
+	m_index.clear();
+	m_index.push_back(0);
+	m_estimator.Clear();
+	m_fromCache = false;
+	m_layers = 0;
 	m_filament = 0;
 	m_height = 0;
 }
@@ -25,50 +25,161 @@ SOFTWARE.
 #ifndef PC_GCODE
 #define PC_GCODE
 
-#include <Point.h>
+#include "MappedFile.hpp"
+#include "Estimator.hpp"
+#include "PreviewCache.hpp"
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace pc
 {
+	class Point
+	{
+		public:
+		float x;
+		float y;
+		
+		Point()
+		{
+		}
+		
+		Point(float x, float y) : x(x), y(y)
+		{
+		}
+	};
+	
 	enum class SegmentType
 	{
 		Fly,
 		Fill
 	};
 	
-	class Segment
+	// letter and value of one G-code word, "X10.5"
+	class Word
 	{
 		public:
-		BPoint start;
-		BPoint end;
-		SegmentType type;
-		int line;
+		char letter;
+		float value;
 	};
 	
-	class Layer
+	// splits a line into words up to the first ';', malformed words are skipped
+	int ScanWords(std::string_view line, Word* words, int max);
+	
+	/*
+		Preview segments stored by columns, a layer is a range of them
+	*/
+	class GRender
 	{
 		public:
-		float z;
-		std::vector<Segment> segments;
 		
-		void Clear()
+		void Clear();
+		void Reserve(size_t segments);
+		
+		// following segments belong to a new layer
+		void AddLayer(float z);
+		
+		void SetLayerZ(int layer, float z)
 		{
-			segments.clear();
+			m_z[layer] = z;
+		}
+		
+		void Add(Point start, Point end, SegmentType type, int line);
+		
+		int Layers() const
+		{
+			return m_z.size();
+		}
+		
+		size_t Segments() const
+		{
+			return m_line.size();
+		}
+		
+		float Z(int layer) const
+		{
+			return m_z[layer];
+		}
+		
+		// segments of a layer are [First, Last)
+		size_t First(int layer) const
+		{
+			return m_first[layer];
+		}
+		
+		size_t Last(int layer) const
+		{
+			return (layer + 1 < Layers()) ? m_first[layer + 1] : Segments();
+		}
+		
+		Point Start(size_t n) const
+		{
+			return Point(m_startX[n], m_startY[n]);
+		}
+		
+		Point End(size_t n) const
+		{
+			return Point(m_endX[n], m_endY[n]);
+		}
+		
+		SegmentType Type(size_t n) const
+		{
+			return ((m_fill[n >> 6] >> (n & 63)) & 1) ? SegmentType::Fill : SegmentType::Fly;
 		}
-	};
-	
-	class GRender
-	{
-		public:
 		
-		std::vector<Layer> layers;
+		// one based file line
+		int Line(size_t n) const
+		{
+			return m_line[n];
+		}
+		
+		// segments coming from lines up to line, they are in file order
+		size_t SegmentsTo(int line) const;
+		
+		// layer segment n belongs to
+		int LayerOf(size_t n) const;
+		
+		// raw columns, one bit per segment in fill words
+		const float* StartX() const
+		{
+			return m_startX.data();
+		}
+		
+		const float* StartY() const
+		{
+			return m_startY.data();
+		}
 		
-		void Clear()
+		const float* EndX() const
 		{
-			layers.clear();
+			return m_endX.data();
 		}
+		
+		const float* EndY() const
+		{
+			return m_endY.data();
+		}
+		
+		const uint64_t* Fill() const
+		{
+			return m_fill.data();
+		}
+		
+		protected:
+		
+		friend class PreviewCache;
+		
+		std::vector<float> m_startX;
+		std::vector<float> m_startY;
+		std::vector<float> m_endX;
+		std::vector<float> m_endY;
+		std::vector<uint64_t> m_fill;
+		std::vector<int> m_line;
+		
+		std::vector<float> m_z;
+		std::vector<size_t> m_first;
 	};
 	
 	class GCode
@@ -79,14 +190,46 @@ namespace pc
 		
 		void LoadFile(const char* filename);
 		
+		// parser threads, 0 means one per core
+		void SetThreads(int threads)
+		{
+			m_threads = threads;
+		}
+		
+		// previews are looked up and stored there when set
+		void SetCache(PreviewCache* cache)
+		{
+			m_cache = cache;
+		}
+		
+		// last load was served by the cache
+		bool FromCache() const
+		{
+			return m_fromCache;
+		}
+		
+		// max distance between an arc and its chords, in mm
+		void SetArcTolerance(float tolerance)
+		{
+			m_arcTolerance = tolerance;
+		}
+		
 		int Lines() const
 		{
-			return m_lines.size();
+			return m_index.size() - 1;
 		}
 		
-		std::string Line(int n) const
+		// view into the mapped file, valid until next LoadFile
+		std::string_view Line(int n) const
 		{
-			return m_lines[n];
+			size_t start = m_index[n];
+			size_t end = m_index[n + 1];
+			
+			while (end > start and (m_file.Data()[end - 1] == '\n' or m_file.Data()[end - 1] == '\r')) {
+				end--;
+			}
+			
+			return std::string_view(m_file.Data() + start, end - start);
 		}
 		
 		float Height() const
@@ -104,6 +247,23 @@ namespace pc
 			return m_layers;
 		}
 		
+		// motion settings assumed before the file changes them
+		void SetLimits(const MotionLimits& limits)
+		{
+			m_estimator.SetLimits(limits);
+		}
+		
+		// estimated print time in seconds
+		double PrintTime() const
+		{
+			return m_estimator.Time();
+		}
+		
+		const std::vector<float>& LayerTimes() const
+		{
+			return m_estimator.LayerTimes();
+		}
+		
 		GRender* Render()
 		{
 			return &fRender;
@@ -111,13 +271,24 @@ namespace pc
 		
 		protected:
 		
+		friend class PreviewCache;
+		
 		void Reset();
 		
 		float m_height;
 		float m_filament;
 		int m_layers;
+		int m_threads;
+		float m_arcTolerance;
+		
+		PreviewCache* m_cache;
+		bool m_fromCache;
+		
+		MappedFile m_file;
+		Estimator m_estimator;
 		
-		std::vector<std::string> m_lines;
+		// start offset of each line, plus a trailing end offset
+		std::vector<size_t> m_index;
 		
 		GRender fRender;
 	};
@@ -0,0 +1,197 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "GCodeStream.hpp"
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	const size_t BufferSize = 64 * 1024;
+	
+	bool IsBlank(char c)
+	{
+		return (c == ' ' or c == '\t' or c == '\r');
+	}
+}
+
+GCodeStream::GCodeStream() : m_fd(-1), m_size(0), m_position(0), m_line(-1), m_eof(true), m_skip(false), m_start(0), m_end(0)
+{
+	m_buffer.resize(BufferSize);
+}
+
+GCodeStream::~GCodeStream()
+{
+	Close();
+}
+
+bool GCodeStream::Open(const char* filename)
+{
+	Close();
+	
+	m_fd = open(filename,O_RDONLY);
+	if (m_fd < 0) {
+		cerr<<"Failed to open "<<filename<<endl;
+		return false;
+	}
+	
+	struct stat st;
+	if (fstat(m_fd,&st) == 0) {
+		m_size = st.st_size;
+	}
+	
+	return Rewind();
+}
+
+void GCodeStream::Close()
+{
+	if (m_fd >= 0) {
+		close(m_fd);
+	}
+	
+	m_fd = -1;
+	m_size = 0;
+	m_position = 0;
+	m_line = -1;
+	m_eof = true;
+	m_skip = false;
+	m_start = 0;
+	m_end = 0;
+}
+
+bool GCodeStream::Rewind()
+{
+	if (m_fd < 0 or lseek(m_fd,0,SEEK_SET) < 0) {
+		return false;
+	}
+	
+	m_position = 0;
+	m_line = -1;
+	m_eof = false;
+	m_skip = false;
+	m_start = 0;
+	m_end = 0;
+	
+	return true;
+}
+
+bool GCodeStream::Fill()
+{
+	//move pending bytes to the front and read after them
+	if (m_start > 0) {
+		memmove(m_buffer.data(), m_buffer.data() + m_start, m_end - m_start);
+		m_end -= m_start;
+		m_start = 0;
+	}
+	
+	ssize_t size = read(m_fd, m_buffer.data() + m_end, m_buffer.size() - m_end);
+	
+	if (size <= 0) {
+		m_eof = true;
+		return false;
+	}
+	
+	m_end += size;
+	return true;
+}
+
+bool GCodeStream::Next(string_view& line)
+{
+	while (true) {
+		char* data = m_buffer.data();
+		char* nl = (char*)memchr(data + m_start, '\n', m_end - m_start);
+		
+		//drop the tail of a line that did not fit in the buffer
+		if (m_skip) {
+			if (nl) {
+				m_position += (nl - data) + 1 - m_start;
+				m_start = (nl - data) + 1;
+				m_skip = false;
+			}
+			else {
+				m_position += m_end - m_start;
+				m_start = m_end;
+				
+				if (m_eof or !Fill()) {
+					return false;
+				}
+			}
+			continue;
+		}
+		
+		size_t end;
+		size_t next;
+		
+		if (nl) {
+			end = nl - data;
+			next = end + 1;
+		}
+		else if (!m_eof and (m_start > 0 or m_end < m_buffer.size())) {
+			Fill();
+			continue;
+		}
+		else if (m_start < m_end) {
+			//last unterminated line, or one longer than the buffer
+			end = m_end;
+			next = m_end;
+			m_skip = !m_eof;
+		}
+		else {
+			return false;
+		}
+		
+		size_t start = m_start;
+		m_position += next - m_start;
+		m_start = next;
+		m_line++;
+		
+		char* semicolon = (char*)memchr(data + start, ';', end - start);
+		if (semicolon) {
+			end = semicolon - data;
+		}
+		
+		while (start < end and IsBlank(data[start])) {
+			start++;
+		}
+		
+		while (end > start and IsBlank(data[end - 1])) {
+			end--;
+		}
+		
+		if (end > start) {
+			line = string_view(data + start, end - start);
+			return true;
+		}
+	}
+}
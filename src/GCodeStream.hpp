@@ -0,0 +1,96 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef PC_GCODE_STREAM
+#define PC_GCODE_STREAM
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace pc
+{
+	/*
+		Sequential reader for printing, keeps a bounded read-ahead buffer
+		instead of loading the whole file
+	*/
+	class GCodeStream
+	{
+		public:
+		
+		GCodeStream();
+		~GCodeStream();
+		
+		GCodeStream(const GCodeStream&) = delete;
+		GCodeStream& operator=(const GCodeStream&) = delete;
+		
+		bool Open(const char* filename);
+		void Close();
+		bool Rewind();
+		
+		bool IsOpen() const
+		{
+			return m_fd >= 0;
+		}
+		
+		// next line with code, comments and blanks stripped
+		// view is valid until the following call
+		bool Next(std::string_view& line);
+		
+		// zero based file line of the last returned line
+		int Line() const
+		{
+			return m_line;
+		}
+		
+		// bytes consumed so far
+		size_t Position() const
+		{
+			return m_position;
+		}
+		
+		size_t Size() const
+		{
+			return m_size;
+		}
+		
+		protected:
+		
+		bool Fill();
+		
+		int m_fd;
+		size_t m_size;
+		size_t m_position;
+		int m_line;
+		bool m_eof;
+		bool m_skip;
+		
+		std::vector<char> m_buffer;
+		size_t m_start;
+		size_t m_end;
+	};
+}
+
+#endif
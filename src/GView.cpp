@@ -23,80 +23,304 @@ SOFTWARE.
 */
 
 #include "GView.hpp"
+#include "Logger.hpp"
 
+#include <OS.h>
 #include <Window.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
 
 using namespace pc;
 using namespace std;
 
-GView::GView(BRect frame,const char* name, uint32 resizingMode, uint32 flags) : BView(frame,name,resizingMode,flags | B_WILL_DRAW), fRender(nullptr)
+namespace
+{
+	//lines per BeginLineArray, app_server sends each array as one message
+	const int32 BatchLines = 2048;
+	
+	/*
+		Lines of one colour, handed to the view as line arrays
+	*/
+	class LineBatch
+	{
+		public:
+		
+		LineBatch(BView* view, rgb_color color) : fView(view), fColor(color), fBatches(0)
+		{
+			fLines.reserve(BatchLines * 2);
+		}
+		
+		void Add(Point start, Point end, float scale)
+		{
+			fLines.push_back(BPoint(start.x * scale, start.y * scale));
+			fLines.push_back(BPoint(end.x * scale, end.y * scale));
+			
+			if (fLines.size() == BatchLines * 2) {
+				Flush();
+			}
+		}
+		
+		void Flush()
+		{
+			if (fLines.empty()) {
+				return;
+			}
+			
+			fView->BeginLineArray(fLines.size() / 2);
+			for (size_t n = 0; n < fLines.size(); n += 2) {
+				fView->AddLine(fLines[n], fLines[n + 1], fColor);
+			}
+			fView->EndLineArray();
+			
+			fLines.clear();
+			fBatches++;
+		}
+		
+		int Batches() const
+		{
+			return fBatches;
+		}
+		
+		protected:
+		
+		BView* fView;
+		rgb_color fColor;
+		vector<BPoint> fLines;
+		int fBatches;
+	};
+}
+
+GView::GView(BRect frame,const char* name, uint32 resizingMode, uint32 flags) : BView(frame,name,resizingMode,flags | B_WILL_DRAW | B_FRAME_EVENTS),
+fRender(nullptr),
+fBitmap(nullptr),
+fShownLayer(-1),
+fCurrentLayer(0),
+fPrinted(0),
+fPrintLayer(-1),
+fDrawTime(0),
+fDraws(0),
+fBatches(0),
+fOverlay(Logger::Enabled(LogLevel::Debug))
 {
 }
 
 GView::~GView()
 {
+	delete fBitmap;
 }
 
 void GView::AttachedToWindow(void)
 {
 	//ResizeTo(Window()->Bounds().right,Window()->Bounds().bottom);
+	UpdateView();
+}
+
+void GView::FrameResized(float width, float height)
+{
+	UpdateView();
+	Invalidate();
+}
+
+void GView::UpdateView()
+{
+	BRect bounds = Bounds();
+	int width = bounds.IntegerWidth() + 1;
+	int height = bounds.IntegerHeight() + 1;
+	
+	fRasters.SetView(2.0, width, height);
+	
+	delete fBitmap;
+	fBitmap = new BBitmap(BRect(0, 0, width - 1, height - 1), B_RGB32);
+	fShownLayer = -1;
 }
 
 void GView::Draw(BRect updateRect)
 {
-	SetScale(2.0);
+	if (!fRender or fRender->Layers() == 0 or !fBitmap) {
+		return;
+	}
+	
+	bigtime_t start = system_time();
+	fBatches = 0;
+	
+	//rendered off screen, see RasterCache
+	if (fShownLayer != fCurrentLayer) {
+		shared_ptr<const Raster> raster = fRasters.Find(fCurrentLayer);
+		
+		if (raster) {
+			fBitmap->ImportBits(raster->Bits(), raster->Bytes(), raster->Width() * 4, 0, B_RGB32);
+			fShownLayer = fCurrentLayer;
+		}
+	}
 	
-	rgb_color color_fly;
-	color_fly.red = 0x0e;
-	color_fly.green = 0x0e;
-	color_fly.blue = 0xff;
+	if (fShownLayer == fCurrentLayer) {
+		DrawBitmap(fBitmap, updateRect, updateRect);
+	}
+	else {
+		//worker has not got to it yet
+		DrawLines(updateRect);
+	}
 	
-	rgb_color color_fill;
-	color_fill.red = 0xff;
-	color_fill.green = 0x0e;
-	color_fill.blue = 0x0e;
+	if (fCurrentLayer == fPrintLayer) {
+		DrawProgress(updateRect);
+	}
 	
-	rgb_color color_back;
-	color_back.red = 0x7e;
-	color_back.green = 0x7e;
-	color_back.blue = 0x7e;
+	fDrawTime = system_time() - start;
+	fDraws++;
 	
+	if (fOverlay) {
+		DrawOverlay(updateRect);
+	}
+}
+
+void GView::DrawOverlay(BRect updateRect)
+{
+	BRect shown = OverlayRect(fOverlayText);
 	
-	if (fRender) {
-		clog<<"drawing layer "<<fCurrentLayer<<endl;
+	//redrawing just the overlay keeps its text, or it would never settle
+	if (!shown.Contains(updateRect)) {
+		char text[64];
+		snprintf(text, sizeof(text), "layer %d  %.2f ms  %d batches", fCurrentLayer, fDrawTime / 1000.0, fBatches);
 		
-		if (fCurrentLayer > 0) {
-			Layer& layer = fRender->layers[fCurrentLayer-1];
-			for (Segment& segment : layer.segments) {
-				
-				if (segment.type == SegmentType::Fly) {
-					continue;
-				}
-				
-				if (segment.type == SegmentType::Fill) {
-					SetHighColor(color_back);
-				}
-				
-				StrokeLine(segment.start,segment.end);
+		//text outside a partial update is still the old one
+		if (fOverlayText != text) {
+			fOverlayText = text;
+			Invalidate(shown | OverlayRect(fOverlayText));
+		}
+	}
+	
+	SetHighColor(0, 0, 0);
+	DrawString(fOverlayText.String(), BPoint(4, 12));
+}
+
+BRect GView::OverlayRect(const BString& text)
+{
+	font_height height;
+	GetFontHeight(&height);
+	
+	return BRect(0, 0, 8 + ceilf(StringWidth(text.String())), 12 + ceilf(height.descent) + 2);
+}
+
+void GView::DrawLines(BRect updateRect)
+{
+	const float scale = 2.0;
+	
+	rgb_color color_fly = {0x0e, 0x0e, 0xff, 0xff};
+	rgb_color color_fill = {0xff, 0x0e, 0x0e, 0xff};
+	rgb_color color_back = {0x7e, 0x7e, 0x7e, 0xff};
+	
+	pc::Bounds view(updateRect.left / scale, updateRect.top / scale, updateRect.right / scale, updateRect.bottom / scale);
+	float pixel = 1.0 / scale;
+	
+	LineBatch back(this, color_back);
+	LineBatch fly(this, color_fly);
+	LineBatch fill(this, color_fill);
+	
+	if (fCurrentLayer > 0) {
+		fRasters.Visit(fCurrentLayer - 1, view, pixel, [&](Point start, Point end, SegmentType type) {
+			if (type == SegmentType::Fill) {
+				back.Add(start, end, scale);
 			}
+		});
+		back.Flush();
+	}
+	
+	fRasters.Visit(fCurrentLayer, view, pixel, [&](Point start, Point end, SegmentType type) {
+		if (type == SegmentType::Fly) {
+			fly.Add(start, end, scale);
+		}
+		else {
+			fill.Add(start, end, scale);
+		}
+	});
+	fly.Flush();
+	fill.Flush();
+	
+	fBatches = back.Batches() + fly.Batches() + fill.Batches();
+}
+
+void GView::DrawProgress(BRect updateRect)
+{
+	const float scale = 2.0;
+	
+	rgb_color color_printed = {0x0e, 0xb0, 0x0e, 0xff};
+	
+	float left = updateRect.left / scale;
+	float top = updateRect.top / scale;
+	float right = updateRect.right / scale;
+	float bottom = updateRect.bottom / scale;
+	
+	const float* startX = fRender->StartX();
+	const float* startY = fRender->StartY();
+	const float* endX = fRender->EndX();
+	const float* endY = fRender->EndY();
+	
+	LineBatch printed(this, color_printed);
+	
+	for (size_t n = fRender->First(fPrintLayer); n < fPrinted; n++) {
+		if (max(startX[n], endX[n]) < left or min(startX[n], endX[n]) > right or
+			max(startY[n], endY[n]) < top or min(startY[n], endY[n]) > bottom) {
+			continue;
 		}
 		
-		Layer& layer = fRender->layers[fCurrentLayer];
-		for (Segment& segment : layer.segments) {
-			
-			if (segment.type == SegmentType::Fly) {
-				SetHighColor(color_fly);
-			}
-			
-			if (segment.type == SegmentType::Fill) {
-				SetHighColor(color_fill);
-			}
-			
-			StrokeLine(segment.start,segment.end);
+		if (fRender->Type(n) == SegmentType::Fill) {
+			printed.Add(fRender->Start(n), fRender->End(n), scale);
+		}
+	}
+	
+	printed.Flush();
+	fBatches += printed.Batches();
+}
+
+void GView::SetProgress(int line)
+{
+	if (!fRender or fRender->Layers() == 0) {
+		return;
+	}
+	
+	size_t printed = fRender->SegmentsTo(line);
+	if (printed == fPrinted) {
+		return;
+	}
+	
+	size_t from = fPrinted;
+	int previous = fPrintLayer;
+	
+	fPrinted = printed;
+	fPrintLayer = (printed > 0) ? fRender->LayerOf(printed - 1) : -1;
+	
+	//new layer or restarted job, whoever was watching the print keeps doing it
+	if (fPrintLayer != previous or printed < from) {
+		if (fCurrentLayer == previous and fPrintLayer >= 0) {
+			fCurrentLayer = fPrintLayer;
 		}
+		
+		Invalidate();
+		return;
+	}
+	
+	if (fCurrentLayer != fPrintLayer) {
+		return;
+	}
+	
+	//only the area covered by what was sent since last time
+	const float scale = 2.0;
+	BRect dirty(1e9, 1e9, -1e9, -1e9);
+	
+	for (size_t n = from; n < printed; n++) {
+		Point start = fRender->Start(n);
+		Point end = fRender->End(n);
+		
+		dirty.left = min(dirty.left, min(start.x, end.x) * scale);
+		dirty.top = min(dirty.top, min(start.y, end.y) * scale);
+		dirty.right = max(dirty.right, max(start.x, end.x) * scale);
+		dirty.bottom = max(dirty.bottom, max(start.y, end.y) * scale);
 	}
+	
+	Invalidate(BRect(dirty.left - 1, dirty.top - 1, dirty.right + 1, dirty.bottom + 1));
 }
 
 void GView::MessageReceived(BMessage* message)
@@ -116,8 +340,8 @@ void GView::MessageReceived(BMessage* message)
 					fCurrentLayer = 0;
 				}
 				
-				if (fRender and fCurrentLayer >= fRender->layers.size()) {
-					fCurrentLayer = fRender->layers.size() - 1;
+				if (fRender and fCurrentLayer >= fRender->Layers()) {
+					fCurrentLayer = std::max(0, fRender->Layers() - 1);
 				}
 				Invalidate();
 			}
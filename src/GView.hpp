@@ -26,7 +26,10 @@ SOFTWARE.
 #define PC_G_VIEW
 
 #include "GCode.hpp"
+#include "RasterCache.hpp"
 
+#include <Bitmap.h>
+#include <String.h>
 #include <View.h>
 
 #include <map>
@@ -43,19 +46,61 @@ namespace pc
 		
 		virtual void AttachedToWindow(void);
 		virtual void Draw(BRect updateRect);
+		virtual void FrameResized(float width, float height);
 		virtual void MessageReceived(BMessage* message);
 		
 		void SetRender(GRender* render)
 		{
 			fCurrentLayer = 0;
 			fRender = render;
+			fRasters.SetRender(render);
+			fShownLayer = -1;
+			fPrinted = 0;
+			fPrintLayer = -1;
 			Invalidate();
 		}
 		
+		// one based file line last sent to the printer
+		void SetProgress(int line);
+		
+		// duration of last Draw, in microseconds
+		bigtime_t DrawTime() const
+		{
+			return fDrawTime;
+		}
+		
+		int32 Draws() const
+		{
+			return fDraws;
+		}
+		
 		protected:
 		
+		void UpdateView();
+		void DrawLines(BRect updateRect);
+		void DrawProgress(BRect updateRect);
+		void DrawOverlay(BRect updateRect);
+		BRect OverlayRect(const BString& text);
+		
 		GRender* fRender;
+		RasterCache fRasters;
+		BBitmap* fBitmap;
+		// layer whose raster fBitmap holds
+		int fShownLayer;
 		int fCurrentLayer;
+		
+		// segments already sent and the layer the last one is in
+		size_t fPrinted;
+		int fPrintLayer;
+		
+		bigtime_t fDrawTime;
+		int32 fDraws;
+		// line arrays sent by last Draw
+		int fBatches;
+		
+		// draw statistics in a corner, with PC_LOG=debug or finer
+		bool fOverlay;
+		BString fOverlayText;
 	};
 }
 #endif
@@ -0,0 +1,90 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "LineBuffer.hpp"
+
+#include <cstring>
+
+using namespace pc;
+
+using namespace std;
+
+LineBuffer::LineBuffer() : m_start(0), m_end(0)
+{
+}
+
+char* LineBuffer::Space()
+{
+	//only the pending partial line is moved, usually a few bytes
+	if (m_start > 0) {
+		memmove(m_data, m_data + m_start, m_end - m_start);
+		m_end -= m_start;
+		m_start = 0;
+	}
+	
+	return m_data + m_end;
+}
+
+size_t LineBuffer::Free() const
+{
+	return Capacity - (m_end - m_start);
+}
+
+void LineBuffer::Commit(size_t size)
+{
+	m_end += size;
+}
+
+bool LineBuffer::Next(string_view& line)
+{
+	if (m_start == m_end) {
+		return false;
+	}
+	
+	const char* nl = (const char*)memchr(m_data + m_start, '\n', m_end - m_start);
+	size_t end;
+	
+	if (nl) {
+		end = (nl - m_data) + 1;
+	}
+	else if (m_start == 0 and m_end == Capacity) {
+		//line does not fit, hand it out as it is
+		end = m_end;
+	}
+	else {
+		return false;
+	}
+	
+	line = string_view(m_data + m_start, end - m_start);
+	m_start = end;
+	
+	return true;
+}
+
+void LineBuffer::Clear()
+{
+	m_start = 0;
+	m_end = 0;
+}
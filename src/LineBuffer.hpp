@@ -0,0 +1,66 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef PC_LINE_BUFFER
+#define PC_LINE_BUFFER
+
+#include <cstddef>
+#include <string_view>
+
+namespace pc
+{
+	/*
+		Fixed size receive buffer, complete lines are handed out in place
+	*/
+	class LineBuffer
+	{
+		public:
+		
+		static const size_t Capacity = 4096;
+		
+		LineBuffer();
+		
+		// where the next read should go, and how much fits
+		char* Space();
+		size_t Free() const;
+		
+		// bytes just written into Space()
+		void Commit(size_t size);
+		
+		// next complete line, including its '\n'
+		// view is valid until the following Space() call
+		bool Next(std::string_view& line);
+		
+		void Clear();
+		
+		protected:
+		
+		char m_data[Capacity];
+		size_t m_start;
+		size_t m_end;
+	};
+}
+
+#endif
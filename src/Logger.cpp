@@ -0,0 +1,372 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Logger.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+using namespace pc;
+
+using namespace std;
+
+atomic<int> Logger::m_level((int)LogLevel::Info);
+
+namespace
+{
+	//lines waiting to be written, power of two
+	const size_t QueueSize = 4096;
+	
+	const char Letters[] = "TDIWE";
+	
+	class Slot
+	{
+		public:
+		
+		atomic<size_t> sequence;
+		LogLevel level;
+		int64_t time;
+		size_t size;
+		char text[Logger::LineSize];
+	};
+	
+	/*
+		Bounded multi producer queue with a single consumer, each slot
+		sequence tells whether it is free for the writer of a given turn
+		or holds a line for the reader
+	*/
+	class Sink
+	{
+		public:
+		
+		Sink();
+		~Sink();
+		
+		void Push(LogLevel level, string_view text);
+		void Flush();
+		bool SetFile(const string& path, size_t bytes, int files);
+		
+		atomic<size_t> dropped;
+		
+		protected:
+		
+		void Run();
+		bool Drain();
+		bool Pending();
+		void Wake();
+		void Write(const string& text);
+		void Rotate();
+		
+		Slot m_slots[QueueSize];
+		atomic<size_t> m_enqueue;
+		atomic<size_t> m_dequeue;
+		chrono::steady_clock::time_point m_start;
+		
+		//file settings, also taken by the writer around each batch
+		mutex m_mutex;
+		condition_variable m_cond;
+		FILE* m_file;
+		string m_path;
+		size_t m_bytes;
+		size_t m_limit;
+		int m_files;
+		bool m_quit;
+		
+		//writer blocks until a Push sees this
+		atomic<bool> m_sleeping;
+		
+		thread m_thread;
+	};
+	
+	Sink::Sink() :
+	dropped(0),
+	m_enqueue(0),
+	m_dequeue(0),
+	m_start(chrono::steady_clock::now()),
+	m_file(nullptr),
+	m_bytes(0),
+	m_limit(0),
+	m_files(0),
+	m_quit(false),
+	m_sleeping(false)
+	{
+		for (size_t n = 0; n < QueueSize; n++) {
+			m_slots[n].sequence.store(n, memory_order_relaxed);
+		}
+		
+		m_thread = thread(&Sink::Run, this);
+	}
+	
+	Sink::~Sink()
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		
+		m_cond.notify_one();
+		m_thread.join();
+		
+		if (m_file) {
+			fclose(m_file);
+		}
+	}
+	
+	void Sink::Push(LogLevel level, string_view text)
+	{
+		size_t position = m_enqueue.load(memory_order_relaxed);
+		Slot* slot;
+		
+		while (true) {
+			slot = &m_slots[position & (QueueSize - 1)];
+			size_t sequence = slot->sequence.load(memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+			
+			if (diff == 0) {
+				if (m_enqueue.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (diff < 0) {
+				//writer is behind a whole queue, never wait for it
+				dropped.fetch_add(1, memory_order_relaxed);
+				return;
+			}
+			else {
+				position = m_enqueue.load(memory_order_relaxed);
+			}
+		}
+		
+		slot->level = level;
+		slot->time = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - m_start).count();
+		slot->size = min(text.size(), Logger::LineSize);
+		text.copy(slot->text, slot->size);
+		
+		//sequentially consistent with the flag in Run, either we see it or it sees the line
+		slot->sequence.store(position + 1, memory_order_seq_cst);
+		
+		if (m_sleeping.load(memory_order_seq_cst)) {
+			Wake();
+		}
+	}
+	
+	void Sink::Run()
+	{
+		unique_lock<mutex> lock(m_mutex);
+		
+		while (true) {
+			bool quit = m_quit;
+			
+			lock.unlock();
+			bool busy = Drain();
+			lock.lock();
+			
+			if (quit and !busy) {
+				return;
+			}
+			
+			if (busy) {
+				continue;
+			}
+			
+			//no timeout, an idle process should not wake up for the log
+			m_sleeping.store(true, memory_order_seq_cst);
+			
+			if (!Pending()) {
+				m_cond.wait(lock, [this]() { return !m_sleeping.load(memory_order_relaxed) or m_quit; });
+			}
+			
+			m_sleeping.store(false, memory_order_relaxed);
+		}
+	}
+	
+	bool Sink::Pending()
+	{
+		size_t position = m_dequeue.load(memory_order_relaxed);
+		return m_slots[position & (QueueSize - 1)].sequence.load(memory_order_seq_cst) == position + 1;
+	}
+	
+	void Sink::Wake()
+	{
+		if (m_sleeping.exchange(false)) {
+			lock_guard<mutex> lock(m_mutex);
+			m_cond.notify_one();
+		}
+	}
+	
+	bool Sink::Drain()
+	{
+		string batch;
+		size_t position = m_dequeue.load(memory_order_relaxed);
+		
+		while (batch.size() < 64 * 1024) {
+			Slot& slot = m_slots[position & (QueueSize - 1)];
+			
+			if (slot.sequence.load(memory_order_acquire) != position + 1) {
+				break;
+			}
+			
+			string_view text(slot.text, slot.size);
+			while (text.size() > 0 and (text.back() == '\n' or text.back() == '\r')) {
+				text.remove_suffix(1);
+			}
+			
+			char prefix[32];
+			int size = snprintf(prefix, sizeof(prefix), "%6lld.%06lld %c ",
+				(long long)(slot.time / 1000000), (long long)(slot.time % 1000000), Letters[(int)slot.level]);
+			
+			batch.append(prefix, size);
+			batch.append(text);
+			batch += '\n';
+			
+			slot.sequence.store(position + QueueSize, memory_order_release);
+			position++;
+		}
+		
+		if (batch.empty()) {
+			return false;
+		}
+		
+		Write(batch);
+		m_dequeue.store(position, memory_order_release);
+		
+		return true;
+	}
+	
+	void Sink::Write(const string& text)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		
+		if (m_file and m_limit > 0 and m_bytes + text.size() > m_limit) {
+			Rotate();
+		}
+		
+		FILE* file = m_file ? m_file : stderr;
+		fwrite(text.data(), 1, text.size(), file);
+		fflush(file);
+		
+		m_bytes += text.size();
+	}
+	
+	void Sink::Rotate()
+	{
+		fclose(m_file);
+		
+		for (int n = m_files - 1; n > 0; n--) {
+			rename((m_path + "." + to_string(n)).c_str(), (m_path + "." + to_string(n + 1)).c_str());
+		}
+		
+		if (m_files > 0) {
+			rename(m_path.c_str(), (m_path + ".1").c_str());
+		}
+		
+		m_file = fopen(m_path.c_str(), "w");
+		m_bytes = 0;
+	}
+	
+	bool Sink::SetFile(const string& path, size_t bytes, int files)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		
+		if (m_file) {
+			fclose(m_file);
+			m_file = nullptr;
+		}
+		
+		m_path = path;
+		m_limit = bytes;
+		m_files = files;
+		m_bytes = 0;
+		
+		if (path.empty()) {
+			return true;
+		}
+		
+		m_file = fopen(path.c_str(), "a");
+		if (!m_file) {
+			return false;
+		}
+		
+		m_bytes = ftell(m_file);
+		return true;
+	}
+	
+	void Sink::Flush()
+	{
+		size_t target = m_enqueue.load(memory_order_acquire);
+		
+		while (m_dequeue.load(memory_order_acquire) < target) {
+			Wake();
+			this_thread::sleep_for(chrono::milliseconds(1));
+		}
+	}
+	
+	Sink& GetSink()
+	{
+		static Sink sink;
+		return sink;
+	}
+}
+
+void Logger::SetLevel(LogLevel level)
+{
+	m_level.store((int)level, memory_order_relaxed);
+}
+
+bool Logger::SetLevel(string_view name)
+{
+	const char* names[] = {"trace", "debug", "info", "warning", "error", "off"};
+	
+	for (int n = 0; n <= (int)LogLevel::Off; n++) {
+		if (name == names[n]) {
+			SetLevel((LogLevel)n);
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+bool Logger::SetFile(const string& path, size_t bytes, int files)
+{
+	return GetSink().SetFile(path, bytes, files);
+}
+
+void Logger::Push(LogLevel level, string_view text)
+{
+	GetSink().Push(level, text);
+}
+
+void Logger::Flush()
+{
+	GetSink().Flush();
+}
+
+size_t Logger::Dropped()
+{
+	return GetSink().dropped.load(memory_order_relaxed);
+}
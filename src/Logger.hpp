@@ -0,0 +1,156 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_LOGGER
+#define PC_LOGGER
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// levels below this one are compiled out, see meson_options.txt
+#ifndef PC_LOG_LEVEL
+#define PC_LOG_LEVEL 0
+#endif
+
+namespace pc
+{
+	enum class LogLevel : int
+	{
+		Trace,
+		Debug,
+		Info,
+		Warning,
+		Error,
+		Off
+	};
+	
+	/*
+		Process wide log. Writers copy their line into a bounded lock free
+		queue and never wait, a background thread writes it to stderr or
+		to a rotated file. Lines are dropped when the queue is full
+	*/
+	class Logger
+	{
+		public:
+		
+		// longest line kept, longer ones are cut
+		static constexpr size_t LineSize = 240;
+		
+		static bool Enabled(LogLevel level)
+		{
+			return (int)level >= PC_LOG_LEVEL and (int)level >= m_level.load(std::memory_order_relaxed);
+		}
+		
+		static void SetLevel(LogLevel level);
+		
+		// by name as in trace, debug, info, warning, error or off
+		static bool SetLevel(std::string_view name);
+		
+		// lines go to path instead of stderr, once it grows past bytes it is
+		// renamed to path.1 and so on, keeping files old ones
+		// empty path goes back to stderr
+		static bool SetFile(const std::string& path, size_t bytes, int files);
+		
+		static void Push(LogLevel level, std::string_view text);
+		
+		// returns once everything pushed so far is written
+		static void Flush();
+		
+		// lines lost to a full queue
+		static size_t Dropped();
+		
+		protected:
+		
+		static std::atomic<int> m_level;
+	};
+	
+	/*
+		Formats one line on the stack, pushed when it goes out of scope
+	*/
+	class LogLine
+	{
+		public:
+		
+		LogLine(LogLevel level) : m_level(level), m_size(0)
+		{
+		}
+		
+		~LogLine()
+		{
+			Logger::Push(m_level, std::string_view(m_text, m_size));
+		}
+		
+		LogLine& operator<<(std::string_view text)
+		{
+			size_t count = std::min(text.size(), Logger::LineSize - m_size);
+			text.copy(m_text + m_size, count);
+			m_size += count;
+			return *this;
+		}
+		
+		LogLine& operator<<(const char* text)
+		{
+			return *this << std::string_view(text);
+		}
+		
+		LogLine& operator<<(const std::string& text)
+		{
+			return *this << std::string_view(text);
+		}
+		
+		LogLine& operator<<(char c)
+		{
+			if (m_size < Logger::LineSize) {
+				m_text[m_size++] = c;
+			}
+			return *this;
+		}
+		
+		template <typename T>
+		LogLine& operator<<(T value)
+		{
+			std::to_chars_result result = std::to_chars(m_text + m_size, m_text + Logger::LineSize, value);
+			if (result.ec == std::errc()) {
+				m_size = result.ptr - m_text;
+			}
+			return *this;
+		}
+		
+		protected:
+		
+		LogLevel m_level;
+		size_t m_size;
+		char m_text[Logger::LineSize];
+	};
+}
+
+// arguments after the macro are not evaluated when the level is filtered
+#define PC_LOG(level) if (!pc::Logger::Enabled(level)) {} else pc::LogLine(level)
+
+#endif
@@ -54,8 +54,22 @@ using namespace pc;
 
 using namespace std;
 
+namespace
+{
+	//preview follows the print at this rate, whatever the line rate is
+	const bigtime_t ProgressPeriod = 1000000 / 15;
+	
+	//echo traffic reaches the console view at most this often
+	const bigtime_t ConsolePeriod = 1000000 / 10;
+	
+	//oldest console text goes beyond either
+	const size_t ConsoleBytes = 1024 * 1024;
+	const size_t ConsoleLines = 10000;
+}
+
 MainWindow::MainWindow()
-: BWindow(BRect(100, 100, 100 + 720, 100 + 512), "Print Control", B_TITLED_WINDOW, 0)
+: BWindow(BRect(100, 100, 100 + 720, 100 + 512), "Print Control", B_TITLED_WINDOW, 0),
+consoleBuffer(ConsoleBytes, ConsoleLines)
 {
 
 	settings = Settings::Load();
@@ -205,6 +219,8 @@ MainWindow::MainWindow()
 	
 	console = new BTextView("console");
 	console->SetWordWrap(false);
+	//contents mirror consoleBuffer
+	console->MakeEditable(false);
 	console->SetResizingMode(B_FOLLOW_ALL);
 	BScrollView* scrollText = new BScrollView("scrollText", console, 0, true, true);
 	//tabView->AddTab(scrollText);
@@ -240,9 +256,12 @@ MainWindow::MainWindow()
 	
 	messenger = BMessenger(nullptr,this);
 	messageRunner = new BMessageRunner(messenger, new BMessage(Message::QueryInfo), 5000000);
+	progressRunner = new BMessageRunner(messenger, new BMessage(Message::Progress), ProgressPeriod);
+	consoleRunner = new BMessageRunner(messenger, new BMessage(Message::ConsoleUpdate), ConsolePeriod);
 	
 	driver = new SerialDriver(this);
 	driver->Run();
+	driver->SetCache(settings);
 	
 	Echo("*** Welcome to PrintControl ***\n");
 	
@@ -283,6 +302,7 @@ void MainWindow::MessageReceived(BMessage* message)
 			delete settings;
 			settings = message;
 			Settings::Save(settings);
+			driver->SetCache(settings);
 		break;
 		
 		case Message::MenuQuit:
@@ -365,13 +385,29 @@ void MainWindow::MessageReceived(BMessage* message)
 			}
 		break;
 		
+		case Message::FileOpened: {
+			//old preview is about to be replaced, parser reuses its columns
+			fGView->SetRender(nullptr);
+			
+			BMessage* released = new BMessage(Message::PreviewReleased);
+			released->AddInt32("generation",message->FindInt32("generation"));
+			driver->PostMessage(released);
+			
+			Echo("File opened, ready to print\n");
+		}
+		break;
+		
 		case Message::FileLoaded: {
 			clog<<"File has been loaded"<<endl;
-			Echo("File loaded\n");
+			Echo(BString("Preview loaded ") << (message->FindBool("cached") ? "from cache " : "")
+				<< "in " << (int32)(message->FindInt64("elapsed") / 1000) << "ms\n");
 			Echo(BString("Number of lines: ") << driver->GCode().Lines() << "\n");
 			Echo(BString("Height: ") << driver->GCode().Height() << "mm\n");
 			Echo(BString("Filament estimation: ") << (int)driver->GCode().Filament() << "mm\n");
 			
+			int seconds = (int)driver->GCode().PrintTime();
+			Echo(BString("Time estimation: ") << seconds / 3600 << "h " << (seconds / 60) % 60 << "m " << seconds % 60 << "s\n");
+			
 			fGView->SetRender(driver->GCode().Render());
 		}
 		break;
@@ -434,6 +470,16 @@ void MainWindow::MessageReceived(BMessage* message)
 			}
 		break;
 		
+		case Message::ConsoleUpdate:
+			UpdateConsole();
+		break;
+		
+		case Message::Progress:
+			if (driver->IsConnected()) {
+				fGView->SetProgress(driver->CurrentLine());
+			}
+		break;
+		
 		default:
 		BWindow::MessageReceived(message);
 	}
@@ -441,8 +487,24 @@ void MainWindow::MessageReceived(BMessage* message)
 
 void MainWindow::Echo(BString text)
 {
-	console->Insert(text.String());
-	console->Invalidate();
+	consoleBuffer.Append(string_view(text.String(), text.Length()));
+}
+
+void MainWindow::UpdateConsole()
+{
+	size_t dropped;
+	string appended;
+	
+	if (!consoleBuffer.Flush(dropped, appended)) {
+		return;
+	}
+	
+	if (dropped > 0) {
+		console->Delete(0, dropped);
+	}
+	
+	console->Insert(console->TextLength(), appended.c_str(), appended.size());
+	console->ScrollToOffset(console->TextLength());
 }
 
 void MainWindow::UpdateStatus()
@@ -488,6 +550,10 @@ void MainWindow::UpdateStatus()
 	if (count > 0) {
 		ss<<" Progress:"<<current<<"/"<<count<<" "<<std::fixed<<std::setprecision(2)<<(100.0f * (float)current/count)<<"%";
 	}
+	
+	if (driver->Resends() > 0) {
+		ss<<" Resends:"<<driver->Resends();
+	}
 	statusText->SetText(ss.str().c_str());
 	
 }
@@ -25,6 +25,7 @@ SOFTWARE.
 #ifndef PC_MAIN_WINDOW
 #define PC_MAIN_WINDOW
 
+#include "ConsoleBuffer.hpp"
 #include "SerialDriver.hpp"
 #include "SettingsWindow.hpp"
 #include "DataView.hpp"
@@ -59,14 +60,18 @@ namespace pc
 		protected:
 		
 		void UpdateStatus();
+		void UpdateConsole();
 		
 		BMessenger messenger;
 		BMessageRunner* messageRunner;
+		BMessageRunner* progressRunner;
+		BMessageRunner* consoleRunner;
 		
 		BMessage* settings;
 		BFilePanel* openPanel;
 		
 		// Console view
+		ConsoleBuffer consoleBuffer;
 		BTextView* console;
 		BTextControl* txtCmd;
 		BButton* btnCmd;
@@ -0,0 +1,99 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "MappedFile.hpp"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <iostream>
+
+using namespace pc;
+
+using namespace std;
+
+MappedFile::MappedFile() : m_data(nullptr), m_size(0), m_modTime(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const char* filename)
+{
+	Close();
+	
+	int fd = open(filename,O_RDONLY);
+	if (fd < 0) {
+		cerr<<"Failed to open "<<filename<<endl;
+		return false;
+	}
+	
+	struct stat st;
+	if (fstat(fd,&st) < 0) {
+		close(fd);
+		return false;
+	}
+	
+	m_modTime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	
+	//an empty file is valid, but there is nothing to map
+	if (st.st_size == 0) {
+		close(fd);
+		return true;
+	}
+	
+	void* data = mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+	//mapping stays alive after closing the descriptor
+	close(fd);
+	
+	if (data == MAP_FAILED) {
+		cerr<<"Failed to map "<<filename<<endl;
+		return false;
+	}
+	
+	//we read it front to back while building the index
+	posix_madvise(data,st.st_size,POSIX_MADV_SEQUENTIAL);
+	
+	m_data = (const char*)data;
+	m_size = st.st_size;
+	
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_data) {
+		munmap((void*)m_data,m_size);
+	}
+	
+	m_data = nullptr;
+	m_size = 0;
+	m_modTime = 0;
+}
@@ -0,0 +1,80 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef PC_MAPPED_FILE
+#define PC_MAPPED_FILE
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace pc
+{
+	/*
+		Read-only memory mapping of a whole file
+	*/
+	class MappedFile
+	{
+		public:
+		
+		MappedFile();
+		~MappedFile();
+		
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		
+		bool Open(const char* filename);
+		void Close();
+		
+		const char* Data() const
+		{
+			return m_data;
+		}
+		
+		size_t Size() const
+		{
+			return m_size;
+		}
+		
+		// modification time of the mapped file, in ns
+		int64_t ModTime() const
+		{
+			return m_modTime;
+		}
+		
+		std::string_view View() const
+		{
+			return std::string_view(m_data,m_size);
+		}
+		
+		protected:
+		
+		const char* m_data;
+		size_t m_size;
+		int64_t m_modTime;
+	};
+}
+
+#endif
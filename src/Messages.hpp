@@ -53,12 +53,16 @@ namespace pc
 		CommandSend,
 
 		LoadFile,
+		FileOpened,
 		FileLoaded,
+		PreviewReleased,
+		Cache,
 		
 		Connect,
 		Connected,
 		Disconnected,
 		Echo,
+		ConsoleUpdate,
 		ReadSerial,
 		
 		Run,
@@ -67,6 +71,7 @@ namespace pc
 		Restart,
 		
 		QueryInfo,
+		Progress,
 		Home,
 		Fan,
 		Hotend,
@@ -0,0 +1,92 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "OkCounter.hpp"
+
+using namespace pc;
+
+using namespace std;
+
+OkCounter::OkCounter() : m_count(0), m_abort(false), m_activity(chrono::steady_clock::now())
+{
+}
+
+void OkCounter::Push()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_count++;
+		m_activity = chrono::steady_clock::now();
+	}
+	
+	m_cond.notify_one();
+}
+
+bool OkCounter::Pop(int timeout)
+{
+	unique_lock<mutex> lock(m_mutex);
+	
+	//long commands keep the printer busy, so only silence counts
+	m_activity = chrono::steady_clock::now();
+	
+	while (m_count == 0) {
+		if (m_abort) {
+			return false;
+		}
+		
+		chrono::steady_clock::time_point deadline = m_activity + chrono::milliseconds(timeout);
+		
+		if (m_cond.wait_until(lock, deadline) == cv_status::timeout and
+			m_count == 0 and chrono::steady_clock::now() >= m_activity + chrono::milliseconds(timeout)) {
+			return false;
+		}
+	}
+	
+	m_count--;
+	return true;
+}
+
+void OkCounter::Reset()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_count = 0;
+	m_abort = false;
+}
+
+void OkCounter::Abort()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_abort = true;
+	}
+	
+	m_cond.notify_all();
+}
+
+void OkCounter::Touch()
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_activity = chrono::steady_clock::now();
+}
@@ -0,0 +1,69 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef PC_OK_COUNTER
+#define PC_OK_COUNTER
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace pc
+{
+	/*
+		Counts firmware acknowledges, senders block until one is available
+	*/
+	class OkCounter
+	{
+		public:
+		
+		OkCounter();
+		
+		// an ok has been received
+		void Push();
+		
+		// waits for an ok, false if the printer stayed silent for timeout ms
+		bool Pop(int timeout);
+		
+		// clears count and abort
+		void Reset();
+		
+		// waiters and later Pops fail at once, firmware will not answer
+		void Abort();
+		
+		// any received line means the printer is still alive
+		void Touch();
+		
+		protected:
+		
+		std::mutex m_mutex;
+		std::condition_variable m_cond;
+		int m_count;
+		bool m_abort;
+		std::chrono::steady_clock::time_point m_activity;
+	};
+}
+
+#endif
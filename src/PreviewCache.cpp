@@ -0,0 +1,493 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "PreviewCache.hpp"
+#include "GCode.hpp"
+
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	const char Magic[8] = {'P','C','P','R','E','V','\0','\0'};
+	const uint32_t Version = 2;
+	
+	//entries are not portable across byte orders
+	const uint32_t ByteOrder = 0x01020304;
+	
+	const char* Extension = ".pcc";
+	
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t byteOrder;
+		uint64_t size;
+		int64_t modTime;
+		uint64_t hash;
+		uint64_t lines;
+		uint64_t layers;
+		uint64_t segments;
+		uint64_t layerTimes;
+		float height;
+		float filament;
+		double time;
+		float arcTolerance;
+		MotionLimits limits;
+	};
+	
+	//every section starts 8 byte aligned, so the entry can be used mapped
+	size_t Align(size_t size)
+	{
+		return (size + 7) & ~size_t(7);
+	}
+	
+	size_t EntrySize(const Header& header)
+	{
+		uint64_t segments = header.segments;
+		
+		return sizeof(Header)
+			+ Align(header.lines * sizeof(uint64_t))
+			+ Align(header.layers * sizeof(float))
+			+ Align(header.layers * sizeof(uint64_t))
+			+ 4 * Align(segments * sizeof(float))
+			+ Align(((segments + 63) / 64) * sizeof(uint64_t))
+			+ Align(segments * sizeof(int32_t))
+			+ Align(header.layerTimes * sizeof(float));
+	}
+	
+	class Writer
+	{
+		public:
+		
+		Writer(int fd) : m_fd(fd), m_ok(true)
+		{
+		}
+		
+		void Put(const void* data, size_t size)
+		{
+			const char* p = (const char*)data;
+			
+			while (m_ok and size > 0) {
+				ssize_t done = write(m_fd, p, size);
+				if (done <= 0) {
+					m_ok = false;
+					break;
+				}
+				p += done;
+				size -= done;
+			}
+		}
+		
+		template <typename T>
+		void Array(const vector<T>& values)
+		{
+			size_t size = values.size() * sizeof(T);
+			const char zero[8] = {0};
+			
+			Put(values.data(), size);
+			Put(zero, Align(size) - size);
+		}
+		
+		// offsets are stored as 64 bits, whatever size_t is
+		void Offsets(const vector<size_t>& values)
+		{
+			if (sizeof(size_t) == sizeof(uint64_t)) {
+				Put(values.data(), values.size() * sizeof(uint64_t));
+				return;
+			}
+			
+			for (size_t value : values) {
+				uint64_t wide = value;
+				Put(&wide, sizeof(wide));
+			}
+		}
+		
+		bool Ok() const
+		{
+			return m_ok;
+		}
+		
+		protected:
+		
+		int m_fd;
+		bool m_ok;
+	};
+	
+	// sizes have been validated before reading
+	class Reader
+	{
+		public:
+		
+		Reader(const char* data) : m_p(data)
+		{
+		}
+		
+		// next section in place
+		template <typename T>
+		const T* Take(size_t count)
+		{
+			const T* values = (const T*)m_p;
+			m_p += Align(count * sizeof(T));
+			return values;
+		}
+		
+		template <typename T>
+		void Array(vector<T>& values, size_t count)
+		{
+			values.resize(count);
+			memcpy(values.data(), Take<T>(count), count * sizeof(T));
+		}
+		
+		void Offsets(vector<size_t>& values, size_t count)
+		{
+			values.resize(count);
+			const uint64_t* wide = Take<uint64_t>(count);
+			
+			for (size_t n = 0; n < count; n++) {
+				values[n] = wide[n];
+			}
+		}
+		
+		protected:
+		
+		const char* m_p;
+	};
+	
+	//offsets and line numbers are used unchecked once loaded
+	bool Consistent(const Header& header, const char* data)
+	{
+		Reader reader(data + sizeof(Header));
+		
+		const uint64_t* index = reader.Take<uint64_t>(header.lines);
+		reader.Take<float>(header.layers);
+		const uint64_t* first = reader.Take<uint64_t>(header.layers);
+		
+		for (int n = 0; n < 4; n++) {
+			reader.Take<float>(header.segments);
+		}
+		
+		reader.Take<uint64_t>((header.segments + 63) / 64);
+		const int* line = reader.Take<int>(header.segments);
+		
+		for (uint64_t n = 1; n < header.lines; n++) {
+			if (index[n] < index[n - 1]) {
+				return false;
+			}
+		}
+		
+		if (index[header.lines - 1] != header.size) {
+			return false;
+		}
+		
+		for (uint64_t n = 0; n < header.layers; n++) {
+			if (first[n] > header.segments or (n > 0 and first[n] < first[n - 1])) {
+				return false;
+			}
+		}
+		
+		//sorted as well, SegmentsTo searches them
+		for (uint64_t n = 0; n < header.segments; n++) {
+			if (line[n] < 0 or (uint64_t)line[n] >= header.lines or (n > 0 and line[n] < line[n - 1])) {
+				return false;
+			}
+		}
+		
+		return true;
+	}
+	
+	bool MakeDirectory(const string& path)
+	{
+		for (size_t n = 1; n <= path.size(); n++) {
+			if (n == path.size() or path[n] == '/') {
+				string parent = path.substr(0, n);
+				if (mkdir(parent.c_str(), 0755) < 0 and errno != EEXIST) {
+					return false;
+				}
+			}
+		}
+		
+		return true;
+	}
+	
+	uint64_t Mix(uint64_t hash, uint64_t value)
+	{
+		hash ^= value * 0x87c37b91114253d5ULL;
+		hash = (hash << 31) | (hash >> 33);
+		return hash * 0x4cf5ad432745937fULL;
+	}
+}
+
+uint64_t pc::HashBytes(const char* data, size_t size)
+{
+	//independent lanes keep several multiplies in flight
+	uint64_t lanes[4] = {
+		0x9e3779b97f4a7c15ULL,
+		0xc2b2ae3d27d4eb4fULL,
+		0x165667b19e3779f9ULL,
+		0x27d4eb2f165667c5ULL
+	};
+	
+	const char* p = data;
+	const char* end = data + size;
+	
+	while (end - p >= 32) {
+		uint64_t words[4];
+		memcpy(words, p, sizeof(words));
+		
+		for (int n = 0; n < 4; n++) {
+			lanes[n] = Mix(lanes[n], words[n]);
+		}
+		
+		p += 32;
+	}
+	
+	uint64_t hash = size;
+	for (int n = 0; n < 4; n++) {
+		hash = Mix(hash, lanes[n]);
+	}
+	
+	while (p < end) {
+		uint64_t word = 0;
+		size_t count = std::min((size_t)(end - p), sizeof(word));
+		memcpy(&word, p, count);
+		hash = Mix(hash, word);
+		p += count;
+	}
+	
+	hash ^= hash >> 29;
+	hash *= 0xbf58476d1ce4e5b9ULL;
+	hash ^= hash >> 32;
+	
+	return hash;
+}
+
+PreviewCache::PreviewCache() : m_limit(256 << 20)
+{
+}
+
+PreviewKey PreviewCache::Key(const char* filename, const GCode& gcode) const
+{
+	const MappedFile& file = gcode.m_file;
+	PreviewKey key;
+	
+	//same file reached through another path is the same entry
+	char resolved[PATH_MAX];
+	string path = realpath(filename, resolved) ? resolved : filename;
+	
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx", (unsigned long long)HashBytes(path.data(), path.size()));
+	
+	key.path = m_directory + "/" + name + Extension;
+	key.size = file.Size();
+	key.modTime = file.ModTime();
+	key.hash = HashBytes(file.Data(), file.Size());
+	key.arcTolerance = gcode.m_arcTolerance;
+	key.limits = gcode.m_estimator.Limits();
+	
+	return key;
+}
+
+bool PreviewCache::Read(const PreviewKey& key, GCode& gcode)
+{
+	if (access(key.path.c_str(), R_OK) != 0) {
+		return false;
+	}
+	
+	MappedFile entry;
+	if (!entry.Open(key.path.c_str()) or entry.Size() < sizeof(Header)) {
+		return false;
+	}
+	
+	Header header;
+	memcpy(&header, entry.Data(), sizeof(header));
+	
+	bool valid = memcmp(header.magic, Magic, sizeof(Magic)) == 0
+		and header.version == Version
+		and header.byteOrder == ByteOrder
+		and header.size == key.size
+		and header.modTime == key.modTime
+		and header.hash == key.hash
+		and header.arcTolerance == key.arcTolerance
+		and memcmp(&header.limits, &key.limits, sizeof(MotionLimits)) == 0
+		and header.lines > 0
+		and EntrySize(header) == entry.Size()
+		and Consistent(header, entry.Data());
+	
+	if (!valid) {
+		clog<<"stale preview cache entry "<<key.path<<endl;
+		return false;
+	}
+	
+	Reader reader(entry.Data() + sizeof(Header));
+	GRender& render = gcode.fRender;
+	
+	reader.Offsets(gcode.m_index, header.lines);
+	reader.Array(render.m_z, header.layers);
+	reader.Offsets(render.m_first, header.layers);
+	reader.Array(render.m_startX, header.segments);
+	reader.Array(render.m_startY, header.segments);
+	reader.Array(render.m_endX, header.segments);
+	reader.Array(render.m_endY, header.segments);
+	reader.Array(render.m_fill, (header.segments + 63) / 64);
+	reader.Array(render.m_line, header.segments);
+	reader.Array(gcode.m_estimator.m_layerTimes, header.layerTimes);
+	
+	gcode.m_estimator.m_time = header.time;
+	gcode.m_height = header.height;
+	gcode.m_filament = header.filament;
+	gcode.m_layers = header.layers;
+	
+	//recently used entries survive eviction
+	utimes(key.path.c_str(), nullptr);
+	
+	return true;
+}
+
+void PreviewCache::Write(const PreviewKey& key, const GCode& gcode)
+{
+	if (!MakeDirectory(m_directory)) {
+		cerr<<"Failed to create preview cache "<<m_directory<<endl;
+		return;
+	}
+	
+	const GRender& render = gcode.fRender;
+	
+	Header header = {};
+	memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	header.byteOrder = ByteOrder;
+	header.size = key.size;
+	header.modTime = key.modTime;
+	header.hash = key.hash;
+	header.lines = gcode.m_index.size();
+	header.layers = render.m_z.size();
+	header.segments = render.m_line.size();
+	header.layerTimes = gcode.m_estimator.m_layerTimes.size();
+	header.height = gcode.m_height;
+	header.filament = gcode.m_filament;
+	header.time = gcode.m_estimator.m_time;
+	header.arcTolerance = key.arcTolerance;
+	header.limits = key.limits;
+	
+	//readers never see a partial entry
+	string temp = key.path + ".tmp";
+	int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		cerr<<"Failed to write preview cache "<<temp<<endl;
+		return;
+	}
+	
+	Writer writer(fd);
+	writer.Put(&header, sizeof(header));
+	writer.Offsets(gcode.m_index);
+	writer.Array(render.m_z);
+	writer.Offsets(render.m_first);
+	writer.Array(render.m_startX);
+	writer.Array(render.m_startY);
+	writer.Array(render.m_endX);
+	writer.Array(render.m_endY);
+	writer.Array(render.m_fill);
+	writer.Array(render.m_line);
+	writer.Array(gcode.m_estimator.m_layerTimes);
+	
+	close(fd);
+	
+	if (!writer.Ok() or rename(temp.c_str(), key.path.c_str()) < 0) {
+		cerr<<"Failed to write preview cache "<<key.path<<endl;
+		unlink(temp.c_str());
+	}
+}
+
+void PreviewCache::Evict()
+{
+	struct Entry
+	{
+		string path;
+		int64_t used;
+		uint64_t size;
+	};
+	
+	DIR* dir = opendir(m_directory.c_str());
+	if (!dir) {
+		return;
+	}
+	
+	vector<Entry> entries;
+	uint64_t total = 0;
+	size_t extension = strlen(Extension);
+	
+	while (dirent* item = readdir(dir)) {
+		string name = item->d_name;
+		
+		if (name.size() <= extension or name.compare(name.size() - extension, extension, Extension) != 0) {
+			continue;
+		}
+		
+		Entry entry;
+		entry.path = m_directory + "/" + name;
+		
+		struct stat st;
+		if (stat(entry.path.c_str(), &st) < 0) {
+			continue;
+		}
+		
+		entry.used = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+		entry.size = st.st_size;
+		total += entry.size;
+		entries.push_back(entry);
+	}
+	
+	closedir(dir);
+	
+	sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return a.used < b.used;
+	});
+	
+	for (const Entry& entry : entries) {
+		if (total <= m_limit) {
+			break;
+		}
+		
+		clog<<"evicting "<<entry.path<<endl;
+		unlink(entry.path.c_str());
+		total -= entry.size;
+	}
+}
@@ -0,0 +1,101 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_PREVIEW_CACHE
+#define PC_PREVIEW_CACHE
+
+#include "Estimator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace pc
+{
+	class GCode;
+	
+	// identifies a G-code file, the settings it was parsed with and the entry holding its preview
+	class PreviewKey
+	{
+		public:
+		
+		std::string path;
+		uint64_t size;
+		int64_t modTime;
+		uint64_t hash;
+		float arcTolerance;
+		MotionLimits limits;
+	};
+	
+	/*
+		Parsed previews stored as binary files in a cache directory, one
+		per G-code path. An entry is used only while size, modification
+		time and content hash of the G-code file, and the arc tolerance
+		and motion limits it was parsed with, still match
+	*/
+	class PreviewCache
+	{
+		public:
+		
+		PreviewCache();
+		
+		// empty directory disables the cache
+		void SetDirectory(const std::string& directory)
+		{
+			m_directory = directory;
+		}
+		
+		// least recently used entries go first past this size
+		void SetLimit(uint64_t bytes)
+		{
+			m_limit = bytes;
+		}
+		
+		bool Enabled() const
+		{
+			return !m_directory.empty() and m_limit > 0;
+		}
+		
+		// gcode has the file mapped and its settings applied
+		PreviewKey Key(const char* filename, const GCode& gcode) const;
+		
+		// fills gcode from a valid entry, untouched otherwise
+		bool Read(const PreviewKey& key, GCode& gcode);
+		
+		void Write(const PreviewKey& key, const GCode& gcode);
+		
+		// removes old entries until the limit is met
+		void Evict();
+		
+		protected:
+		
+		std::string m_directory;
+		uint64_t m_limit;
+	};
+	
+	// 64 bit hash of a memory block, fast enough to run on every open
+	uint64_t HashBytes(const char* data, size_t size);
+}
+
+#endif
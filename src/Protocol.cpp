@@ -0,0 +1,437 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Protocol.hpp"
+#include "Logger.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	//lines prepared ahead of sending
+	const int Lookahead = 32;
+	
+	bool IsCommand(string_view line, string_view code)
+	{
+		return line.substr(0, code.size()) == code and
+			(line.size() == code.size() or line[code.size()] < '0' or line[code.size()] > '9');
+	}
+}
+
+Protocol::Protocol() :
+m_mode(SendMode::PingPong),
+m_timeout(30000),
+m_printLine(0),
+m_sendLine(1),
+m_lostLine(0),
+m_ignoreResends(0),
+m_resends(0),
+m_resendLine(0),
+m_resendCount(0),
+m_autoReport(0),
+m_capabilities(0),
+m_autoReporting(false),
+m_queued(0),
+m_outOfBand(0),
+m_halted(false),
+m_fileLine(0)
+{
+}
+
+Protocol::~Protocol()
+{
+}
+
+void Protocol::SetMode(SendMode mode, int lines, size_t bytes)
+{
+	m_mode = mode;
+	m_window.SetLimits(lines, bytes);
+}
+
+bool Protocol::Open(const char* filename)
+{
+	//progress of a previous job must not show on the new one
+	m_fileLine = 0;
+	
+	return m_stream.Open(filename);
+}
+
+void Protocol::Close()
+{
+	m_fileLine = 0;
+	m_stream.Close();
+}
+
+void Protocol::Reset()
+{
+	m_halted = false;
+	m_ok.Reset();
+	m_window.Clear();
+	m_outOfBand = 0;
+	m_capabilities = 0;
+	m_autoReporting = false;
+	
+	lock_guard<mutex> lock(m_queueMutex);
+	m_queue.clear();
+	m_queued = 0;
+}
+
+bool Protocol::Start()
+{
+	if (!m_stream.Rewind()) {
+		return false;
+	}
+	
+	m_buffer.Clear();
+	m_printLine = 0;
+	m_sendLine = 1;
+	m_fileLine = 0;
+	m_resends.store(0);
+	m_ignoreResends = 0;
+	m_resendCount = 0;
+	
+	//firmware was reset after an emergency stop
+	if (m_halted) {
+		m_halted = false;
+		m_ok.Reset();
+	}
+	
+	//firmware expects N1 next
+	if (!Exec("M110 N0")) {
+		return false;
+	}
+	
+	//Cap: lines arrive before the ok, firmware without M115 just answers ok
+	m_capabilities = 0;
+	m_autoReporting = false;
+	
+	if (!Exec("M115")) {
+		return false;
+	}
+	
+	if (m_autoReport > 0 and (m_capabilities & CapabilityAutoReport)) {
+		if (!Exec("M155 S" + to_string(m_autoReport))) {
+			return false;
+		}
+		m_autoReporting = true;
+	}
+	
+	PC_LOG(LogLevel::Info)<<"capabilities:"<<m_capabilities.load()<<" auto report:"<<(m_autoReporting ? "on" : "off");
+	
+	return true;
+}
+
+StepResult Protocol::Step()
+{
+	if (m_halted) {
+		return StepResult::Halted;
+	}
+	
+	if (!CheckResend()) {
+		Drain();
+		return StepResult::Lost;
+	}
+	
+	//interactive commands take the next slot, their oks come in order
+	if (m_queued > 0 and !SendQueued()) {
+		m_window.Clear();
+		return m_halted ? StepResult::Halted : StepResult::NoResponse;
+	}
+	
+	//prepare upcoming lines in batches
+	if (m_printLine - m_sendLine < Lookahead / 2) {
+		Prefetch();
+	}
+	
+	if (m_sendLine > m_printLine) {
+		Drain();
+		
+		//last lines may still be asked for again
+		if (m_resendCount > 0) {
+			return StepResult::Continue;
+		}
+		
+		return StepResult::Ended;
+	}
+	
+	string_view code;
+	if (!m_buffer.Get(m_sendLine, code)) {
+		m_lostLine = m_sendLine;
+		Drain();
+		return StepResult::Lost;
+	}
+	
+	m_fileLine = m_buffer.FileLine(m_sendLine) + 1;
+	
+	PC_LOG(LogLevel::Trace)<<">>"<<code;
+	
+	if (!Transmit(code)) {
+		m_window.Clear();
+		return m_halted ? StepResult::Halted : StepResult::NoResponse;
+	}
+	
+	m_sendLine++;
+	
+	return StepResult::Continue;
+}
+
+bool Protocol::Exec(string_view line)
+{
+	//its ok must not be taken for a print line
+	Drain();
+	
+	//strip comments
+	line = line.substr(0, line.find(';'));
+	
+	PC_LOG(LogLevel::Debug)<<"command:"<<line;
+	
+	string tmp(line);
+	tmp += '\n';
+	Write(tmp);
+	
+	return PopOk();
+}
+
+void Protocol::Queue(string_view line)
+{
+	//strip comments and blanks, firmware does not answer empty lines
+	line = line.substr(0, line.find(';'));
+	
+	while (line.size() > 0 and (line.front() == ' ' or line.front() == '\t')) {
+		line.remove_prefix(1);
+	}
+	while (line.size() > 0 and (line.back() == ' ' or line.back() == '\t' or line.back() == '\n' or line.back() == '\r')) {
+		line.remove_suffix(1);
+	}
+	
+	if (line.empty()) {
+		return;
+	}
+	
+	string tmp(line);
+	tmp += '\n';
+	
+	//cannot wait behind the job, firmware halts and answers nothing more
+	if (IsCommand(line, "M112")) {
+		PC_LOG(LogLevel::Warning)<<"emergency stop";
+		m_halted = true;
+		Write(tmp);
+		m_ok.Abort();
+		return;
+	}
+	
+	//emergency parser acts on arrival, the copy left in its queue still answers ok
+	if ((m_capabilities & CapabilityEmergencyParser) and (IsCommand(line, "M108") or IsCommand(line, "M410"))) {
+		PC_LOG(LogLevel::Debug)<<"out of band:"<<line;
+		m_outOfBand++;
+		Write(tmp);
+		return;
+	}
+	
+	lock_guard<mutex> lock(m_queueMutex);
+	m_queue.push_back(std::move(tmp));
+	m_queued++;
+}
+
+bool Protocol::ExecQueued()
+{
+	string line;
+	
+	while (PopQueued(line)) {
+		line.pop_back();
+		
+		if (!Exec(line)) {
+			//the rest would only time out as well
+			lock_guard<mutex> lock(m_queueMutex);
+			m_queue.clear();
+			m_queued = 0;
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+void Protocol::Drain()
+{
+	while (!m_window.Empty()) {
+		if (!PopOk()) {
+			m_window.Clear();
+			break;
+		}
+		m_window.Pop();
+	}
+}
+
+void Protocol::Receive(string_view line, Response& response)
+{
+	ParseResponse(line, response);
+	
+	//printer is alive, but auto reports keep coming even when an ok got lost
+	if (response.type != ResponseType::Temperature or response.ok or response.Has(FieldWait)) {
+		m_ok.Touch();
+	}
+	
+	if (response.resend >= 0) {
+		m_resendLine = response.resend;
+		m_resendCount++;
+		return;
+	}
+	
+	if (response.type == ResponseType::Capability) {
+		string_view text = response.text.substr(0, response.text.find_first_of("\r\n"));
+		
+		if (text == "AUTOREPORT_TEMP:1") {
+			m_capabilities |= CapabilityAutoReport;
+		}
+		else if (text == "EMERGENCY_PARSER:1") {
+			m_capabilities |= CapabilityEmergencyParser;
+		}
+		return;
+	}
+	
+	//auto reports come without ok and leave the count alone
+	if (response.ok) {
+		//answer to a line written past the window, see Queue
+		if (m_outOfBand > 0) {
+			m_outOfBand--;
+			return;
+		}
+		
+		m_ok.Push();
+	}
+}
+
+void Protocol::Write(string_view data)
+{
+	lock_guard<mutex> lock(m_sendMutex);
+	Send(data);
+}
+
+bool Protocol::Transmit(string_view line)
+{
+	if (m_mode == SendMode::PingPong) {
+		Write(line);
+		return PopOk();
+	}
+	
+	//every ok frees the oldest line in flight
+	while (!m_window.CanSend(line.size())) {
+		bool acked = PopOk();
+		m_window.Pop();
+		
+		if (!acked) {
+			return false;
+		}
+	}
+	
+	Write(line);
+	m_window.Push(line.size());
+	
+	return true;
+}
+
+bool Protocol::SendQueued()
+{
+	string line;
+	
+	while (PopQueued(line)) {
+		PC_LOG(LogLevel::Debug)<<"command:"<<string_view(line.data(), line.size() - 1);
+		
+		if (!Transmit(line)) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool Protocol::PopQueued(string& line)
+{
+	lock_guard<mutex> lock(m_queueMutex);
+	
+	if (m_queue.empty()) {
+		return false;
+	}
+	
+	line = std::move(m_queue.front());
+	m_queue.pop_front();
+	m_queued--;
+	
+	return true;
+}
+
+bool Protocol::PopOk()
+{
+	return m_ok.Pop(m_timeout);
+}
+
+void Protocol::Prefetch()
+{
+	string_view line;
+	
+	while (m_printLine - m_sendLine + 1 < Lookahead and m_stream.Next(line)) {
+		m_printLine++;
+		m_buffer.Append(m_printLine, line, m_stream.Line());
+	}
+}
+
+bool Protocol::CheckResend()
+{
+	int count = m_resendCount.exchange(0);
+	
+	if (count == 0) {
+		return true;
+	}
+	
+	//every line sent after a bad one is refused with the same request
+	if (m_ignoreResends >= count) {
+		m_ignoreResends -= count;
+		return true;
+	}
+	
+	count -= m_ignoreResends;
+	
+	int line = m_resendLine;
+	string_view sent;
+	
+	if (!m_buffer.Get(line, sent)) {
+		m_lostLine = line;
+		return false;
+	}
+	
+	PC_LOG(LogLevel::Info)<<"resend from "<<line;
+	
+	m_ignoreResends = std::max(0, (m_sendLine - 1 - line) - (count - 1));
+	m_sendLine = line;
+	m_resends++;
+	
+	return true;
+}
@@ -0,0 +1,213 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_PROTOCOL
+#define PC_PROTOCOL
+
+#include "GCodeStream.hpp"
+#include "SendWindow.hpp"
+#include "OkCounter.hpp"
+#include "SendBuffer.hpp"
+#include "Response.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace pc
+{
+	enum class SendMode {
+		PingPong,
+		Window
+	};
+	
+	// firmware features announced on M115
+	enum Capability : uint32_t {
+		CapabilityAutoReport = 1,
+		CapabilityEmergencyParser = 2
+	};
+	
+	enum class StepResult {
+		Continue,
+		Ended,
+		NoResponse,
+		Lost,
+		Halted
+	};
+	
+	/*
+		Host side of the line protocol: numbering, checksums, lines in
+		flight, acknowledges and resends. Subclasses provide the transport
+	*/
+	class Protocol
+	{
+		public:
+		
+		Protocol();
+		virtual ~Protocol();
+		
+		void SetMode(SendMode mode, int lines, size_t bytes);
+		
+		// ms of printer silence before giving up on an ok
+		void SetTimeout(int timeout)
+		{
+			m_timeout = timeout;
+		}
+		
+		// seconds between temperature reports asked for on Start, 0 disables
+		void SetAutoReport(int seconds)
+		{
+			m_autoReport = seconds;
+		}
+		
+		bool Open(const char* filename);
+		void Close();
+		
+		bool IsOpen() const
+		{
+			return m_stream.IsOpen();
+		}
+		
+		// forgets the previous connection, its halt, oks and queued commands
+		void Reset();
+		
+		// rewinds the job, restarts firmware numbering and asks for capabilities
+		bool Start();
+		
+		// sends the next job line, or the one asked for again
+		StepResult Step();
+		
+		// unnumbered command, waits for its ok
+		bool Exec(std::string_view line);
+		
+		// interactive command, goes out before the next job line, safe from any thread
+		void Queue(std::string_view line);
+		
+		// sends queued commands one by one while no job is stepping
+		bool ExecQueued();
+		
+		// wait until every line in flight is acknowledged
+		void Drain();
+		
+		// feeds a line read from the printer, safe from any thread
+		void Receive(std::string_view line, Response& response);
+		
+		// one based file line of the last line sent
+		int CurrentLine() const
+		{
+			return m_fileLine;
+		}
+		
+		// line number that could not be sent again after Lost
+		int LostLine() const
+		{
+			return m_lostLine;
+		}
+		
+		// Capability bits from last Start
+		uint32_t Capabilities() const
+		{
+			return m_capabilities;
+		}
+		
+		// firmware sends temperatures on its own, no need to poll
+		bool AutoReporting() const
+		{
+			return m_autoReporting;
+		}
+		
+		// resend requests honored in current job
+		int Resends() const
+		{
+			return m_resends.load();
+		}
+		
+		size_t Position() const
+		{
+			return m_stream.Position();
+		}
+		
+		size_t Size() const
+		{
+			return m_stream.Size();
+		}
+		
+		protected:
+		
+		virtual void Send(std::string_view data) = 0;
+		
+		// Send from any thread, lines are never interleaved
+		void Write(std::string_view data);
+		
+		// sends a line through the window, false when its slot never came free
+		bool Transmit(std::string_view line);
+		bool SendQueued();
+		bool PopQueued(std::string& line);
+		
+		bool PopOk();
+		bool CheckResend();
+		void Prefetch();
+		
+		GCodeStream m_stream;
+		SendBuffer m_buffer;
+		
+		SendMode m_mode;
+		SendWindow m_window;
+		
+		OkCounter m_ok;
+		int m_timeout;
+		
+		int m_printLine;
+		int m_sendLine;
+		int m_lostLine;
+		int m_ignoreResends;
+		
+		// written by the looper, polled by the window
+		std::atomic<int> m_resends;
+		std::atomic<int> m_resendLine;
+		std::atomic<int> m_resendCount;
+		
+		int m_autoReport;
+		std::atomic<uint32_t> m_capabilities;
+		std::atomic<bool> m_autoReporting;
+		
+		std::mutex m_sendMutex;
+		std::mutex m_queueMutex;
+		std::deque<std::string> m_queue;
+		std::atomic<int> m_queued;
+		
+		// oks still due for lines written past the window
+		std::atomic<int> m_outOfBand;
+		std::atomic<bool> m_halted;
+		
+		// polled by the user interface while printing
+		std::atomic<int> m_fileLine;
+	};
+}
+
+#endif
@@ -0,0 +1,415 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "RasterCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	const size_t DefaultBudget = 64 * 1024 * 1024;
+	
+	const int DefaultLookahead = 4;
+	
+	/*
+		Liang-Barsky, false when nothing of the segment is left
+	*/
+	bool Clip(float& x0, float& y0, float& x1, float& y1, float right, float bottom)
+	{
+		float dx = x1 - x0;
+		float dy = y1 - y0;
+		float t0 = 0.0f;
+		float t1 = 1.0f;
+		
+		const float p[4] = {-dx, dx, -dy, dy};
+		const float q[4] = {x0, right - x0, y0, bottom - y0};
+		
+		for (int n = 0; n < 4; n++) {
+			if (p[n] == 0.0f) {
+				if (q[n] < 0.0f) {
+					return false;
+				}
+				continue;
+			}
+			
+			float t = q[n] / p[n];
+			
+			if (p[n] < 0.0f) {
+				t0 = max(t0, t);
+			}
+			else {
+				t1 = min(t1, t);
+			}
+		}
+		
+		if (t0 > t1) {
+			return false;
+		}
+		
+		x1 = x0 + t1 * dx;
+		y1 = y0 + t1 * dy;
+		x0 = x0 + t0 * dx;
+		y0 = y0 + t0 * dy;
+		
+		return true;
+	}
+}
+
+Raster::Raster(int width, int height) :
+m_width(width),
+m_height(height),
+m_pixels((size_t)width * height)
+{
+}
+
+void Raster::Clear(uint32_t color)
+{
+	std::fill(m_pixels.begin(), m_pixels.end(), color);
+}
+
+void Raster::Line(float x0, float y0, float x1, float y1, uint32_t color)
+{
+	if (!Clip(x0, y0, x1, y1, m_width - 1, m_height - 1)) {
+		return;
+	}
+	
+	float dx = x1 - x0;
+	float dy = y1 - y0;
+	int steps = (int)ceil(max(fabs(dx), fabs(dy)));
+	
+	//dda along the major axis, endpoints included
+	float sx = (steps > 0) ? dx / steps : 0.0f;
+	float sy = (steps > 0) ? dy / steps : 0.0f;
+	float x = x0 + 0.5f;
+	float y = y0 + 0.5f;
+	uint32_t* pixels = m_pixels.data();
+	
+	for (int n = 0; n <= steps; n++) {
+		int px = min((int)x, m_width - 1);
+		int py = min((int)y, m_height - 1);
+		pixels[(size_t)py * m_width + px] = color;
+		x += sx;
+		y += sy;
+	}
+}
+
+Palette::Palette() :
+background(PackColor(0xff, 0xff, 0xff)),
+fly(PackColor(0x0e, 0x0e, 0xff)),
+fill(PackColor(0xff, 0x0e, 0x0e)),
+previous(PackColor(0x7e, 0x7e, 0x7e))
+{
+}
+
+RasterCache::RasterCache() :
+m_render(nullptr),
+m_scale(1.0f),
+m_width(0),
+m_height(0),
+m_budget(DefaultBudget),
+m_lookahead(DefaultLookahead),
+m_quit(false),
+m_bytes(0),
+m_hits(0),
+m_misses(0),
+m_prefetched(0),
+m_worker(&RasterCache::Work, this)
+{
+}
+
+RasterCache::~RasterCache()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	
+	m_cond.notify_one();
+	m_worker.join();
+}
+
+void RasterCache::SetRender(const GRender* render)
+{
+	lock_guard<mutex> render_lock(m_renderMutex);
+	lock_guard<mutex> lock(m_mutex);
+	
+	m_render = render;
+	m_index.SetRender(render);
+	Drop();
+}
+
+void RasterCache::SetView(float scale, int width, int height)
+{
+	lock_guard<mutex> render_lock(m_renderMutex);
+	lock_guard<mutex> lock(m_mutex);
+	
+	if (scale == m_scale and width == m_width and height == m_height) {
+		return;
+	}
+	
+	m_scale = scale;
+	m_width = width;
+	m_height = height;
+	Drop();
+}
+
+void RasterCache::SetPalette(const Palette& palette)
+{
+	lock_guard<mutex> render_lock(m_renderMutex);
+	lock_guard<mutex> lock(m_mutex);
+	
+	m_palette = palette;
+	Drop();
+}
+
+void RasterCache::SetBudget(size_t bytes)
+{
+	lock_guard<mutex> lock(m_mutex);
+	
+	m_budget = bytes;
+	
+	while (m_bytes > m_budget and !m_ages.empty()) {
+		auto entry = m_entries.find(m_ages.back());
+		m_bytes -= entry->second.raster->Bytes();
+		m_entries.erase(entry);
+		m_ages.pop_back();
+	}
+}
+
+void RasterCache::SetLookahead(int layers)
+{
+	lock_guard<mutex> lock(m_mutex);
+	m_lookahead = layers;
+}
+
+shared_ptr<const Raster> RasterCache::Get(int layer)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		
+		if (!m_render or layer < 0 or layer >= m_render->Layers() or m_width <= 0 or m_height <= 0) {
+			return nullptr;
+		}
+		
+		shared_ptr<const Raster> raster = Lookup(layer);
+		if (raster) {
+			return raster;
+		}
+	}
+	
+	lock_guard<mutex> render_lock(m_renderMutex);
+	
+	//worker may have just finished it, or the view changed meanwhile
+	{
+		lock_guard<mutex> lock(m_mutex);
+		
+		if (!m_render or layer >= m_render->Layers() or m_width <= 0 or m_height <= 0) {
+			return nullptr;
+		}
+		
+		shared_ptr<const Raster> raster = Lookup(layer);
+		if (raster) {
+			return raster;
+		}
+	}
+	
+	shared_ptr<const Raster> raster = Render(layer);
+	
+	lock_guard<mutex> lock(m_mutex);
+	m_misses++;
+	Insert(layer, raster);
+	Queue(layer);
+	
+	return raster;
+}
+
+shared_ptr<const Raster> RasterCache::Find(int layer)
+{
+	lock_guard<mutex> lock(m_mutex);
+	
+	if (!m_render or layer < 0 or layer >= m_render->Layers() or m_width <= 0 or m_height <= 0) {
+		return nullptr;
+	}
+	
+	shared_ptr<const Raster> raster = Lookup(layer);
+	if (raster) {
+		return raster;
+	}
+	
+	m_misses++;
+	Queue(layer);
+	
+	//the missing one goes first
+	if (m_budget > 0) {
+		m_queue.push_front(layer);
+		m_cond.notify_one();
+	}
+	
+	return nullptr;
+}
+
+shared_ptr<const Raster> RasterCache::Lookup(int layer)
+{
+	auto entry = m_entries.find(layer);
+	if (entry == m_entries.end()) {
+		return nullptr;
+	}
+	
+	m_ages.splice(m_ages.begin(), m_ages, entry->second.age);
+	m_hits++;
+	Queue(layer);
+	
+	return entry->second.raster;
+}
+
+shared_ptr<Raster> RasterCache::Render(int layer)
+{
+	shared_ptr<Raster> raster = make_shared<Raster>(m_width, m_height);
+	raster->Clear(m_palette.background);
+	
+	Bounds view(0.0f, 0.0f, m_width / m_scale, m_height / m_scale);
+	float pixel = 1.0f / m_scale;
+	float scale = m_scale;
+	
+	if (layer > 0) {
+		uint32_t color = m_palette.previous;
+		
+		m_index.Visit(layer - 1, view, pixel, [&](Point start, Point end, SegmentType type) {
+			if (type == SegmentType::Fill) {
+				raster->Line(start.x * scale, start.y * scale, end.x * scale, end.y * scale, color);
+			}
+		});
+	}
+	
+	const Palette& palette = m_palette;
+	
+	m_index.Visit(layer, view, pixel, [&](Point start, Point end, SegmentType type) {
+		uint32_t color = (type == SegmentType::Fly) ? palette.fly : palette.fill;
+		raster->Line(start.x * scale, start.y * scale, end.x * scale, end.y * scale, color);
+	});
+	
+	return raster;
+}
+
+void RasterCache::Insert(int layer, shared_ptr<const Raster> raster)
+{
+	if (m_budget == 0 or m_entries.count(layer) > 0) {
+		return;
+	}
+	
+	m_ages.push_front(layer);
+	
+	Entry& entry = m_entries[layer];
+	entry.raster = raster;
+	entry.age = m_ages.begin();
+	m_bytes += raster->Bytes();
+	
+	//the one just added always stays
+	while (m_bytes > m_budget and m_ages.size() > 1) {
+		auto old = m_entries.find(m_ages.back());
+		m_bytes -= old->second.raster->Bytes();
+		m_entries.erase(old);
+		m_ages.pop_back();
+	}
+}
+
+void RasterCache::Drop()
+{
+	m_entries.clear();
+	m_ages.clear();
+	m_queue.clear();
+	m_bytes = 0;
+}
+
+void RasterCache::Queue(int layer)
+{
+	m_queue.clear();
+	
+	if (m_budget == 0) {
+		return;
+	}
+	
+	//never ask for more than fits, or prefetching evicts its own work
+	size_t bytes = (size_t)m_width * m_height * sizeof(uint32_t);
+	int fits = (bytes > 0) ? (int)min<size_t>(m_budget / bytes, 1 << 20) : 0;
+	int lookahead = min(m_lookahead, (fits - 1) / 2);
+	
+	//nearest first, scrolling forward is the common case
+	for (int n = 1; n <= lookahead; n++) {
+		if (layer + n < m_render->Layers() and m_entries.count(layer + n) == 0) {
+			m_queue.push_back(layer + n);
+		}
+		
+		if (layer - n >= 0 and m_entries.count(layer - n) == 0) {
+			m_queue.push_back(layer - n);
+		}
+	}
+	
+	if (!m_queue.empty()) {
+		m_cond.notify_one();
+	}
+}
+
+void RasterCache::Work()
+{
+	while (true) {
+		int layer;
+		
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_cond.wait(lock, [this]() {
+				return m_quit or !m_queue.empty();
+			});
+			
+			if (m_quit) {
+				return;
+			}
+			
+			layer = m_queue.front();
+			m_queue.pop_front();
+		}
+		
+		lock_guard<mutex> render_lock(m_renderMutex);
+		
+		{
+			lock_guard<mutex> lock(m_mutex);
+			
+			//view may have changed while waiting for the renderer
+			if (!m_render or layer >= m_render->Layers() or m_width <= 0 or m_height <= 0 or m_entries.count(layer) > 0) {
+				continue;
+			}
+		}
+		
+		shared_ptr<const Raster> raster = Render(layer);
+		
+		lock_guard<mutex> lock(m_mutex);
+		Insert(layer, raster);
+		m_prefetched++;
+	}
+}
@@ -0,0 +1,223 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_RASTER_CACHE
+#define PC_RASTER_CACHE
+
+#include "GCode.hpp"
+#include "RenderIndex.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace pc
+{
+	// packed as B_RGB32, blue in the lowest byte
+	inline uint32_t PackColor(uint8_t red, uint8_t green, uint8_t blue)
+	{
+		return 0xff000000u | (uint32_t(red) << 16) | (uint32_t(green) << 8) | uint32_t(blue);
+	}
+	
+	/*
+		32 bit software image with one pixel wide lines
+	*/
+	class Raster
+	{
+		public:
+		
+		Raster(int width, int height);
+		
+		int Width() const
+		{
+			return m_width;
+		}
+		
+		int Height() const
+		{
+			return m_height;
+		}
+		
+		const uint32_t* Bits() const
+		{
+			return m_pixels.data();
+		}
+		
+		size_t Bytes() const
+		{
+			return m_pixels.size() * sizeof(uint32_t);
+		}
+		
+		void Clear(uint32_t color);
+		
+		// clipped to the image, coordinates in pixels
+		void Line(float x0, float y0, float x1, float y1, uint32_t color);
+		
+		protected:
+		
+		int m_width;
+		int m_height;
+		std::vector<uint32_t> m_pixels;
+	};
+	
+	class Palette
+	{
+		public:
+		
+		Palette();
+		
+		uint32_t background;
+		uint32_t fly;
+		uint32_t fill;
+		// fill of the layer below the shown one
+		uint32_t previous;
+	};
+	
+	/*
+		Rendered layers kept within a memory budget, least recently used
+		ones go first. A worker thread renders the neighbours of the last
+		requested layer so scrolling through them is a copy
+	*/
+	class RasterCache
+	{
+		public:
+		
+		RasterCache();
+		~RasterCache();
+		
+		// drops every raster
+		void SetRender(const GRender* render);
+		
+		// pixels per mm and image size, drops every raster on change
+		void SetView(float scale, int width, int height);
+		
+		void SetPalette(const Palette& palette);
+		
+		// bytes of rasters kept, 0 disables caching
+		void SetBudget(size_t bytes);
+		
+		// how many layers each side of the requested one are pre-rendered
+		void SetLookahead(int layers);
+		
+		// raster of layer, rendered on the calling thread when missing
+		std::shared_ptr<const Raster> Get(int layer);
+		
+		// raster of layer if there is one, otherwise the worker is asked
+		// for it and nullptr returned
+		std::shared_ptr<const Raster> Find(int layer);
+		
+		// RenderIndex::Visit on the index rasters are made from
+		template <typename F>
+		size_t Visit(int layer, const Bounds& view, float pixel, F emit)
+		{
+			std::lock_guard<std::mutex> lock(m_renderMutex);
+			
+			if (!m_render or layer < 0 or layer >= m_render->Layers()) {
+				return 0;
+			}
+			
+			return m_index.Visit(layer, view, pixel, emit);
+		}
+		
+		size_t Hits() const
+		{
+			return m_hits;
+		}
+		
+		size_t Misses() const
+		{
+			return m_misses;
+		}
+		
+		// rendered by the worker
+		size_t Prefetched() const
+		{
+			return m_prefetched;
+		}
+		
+		size_t Bytes() const
+		{
+			return m_bytes;
+		}
+		
+		protected:
+		
+		class Entry
+		{
+			public:
+			
+			std::shared_ptr<const Raster> raster;
+			std::list<int>::iterator age;
+		};
+		
+		// caller holds m_renderMutex
+		std::shared_ptr<Raster> Render(int layer);
+		
+		// caller holds m_mutex
+		std::shared_ptr<const Raster> Lookup(int layer);
+		void Insert(int layer, std::shared_ptr<const Raster> raster);
+		void Drop();
+		void Queue(int layer);
+		
+		void Work();
+		
+		const GRender* m_render;
+		RenderIndex m_index;
+		Palette m_palette;
+		float m_scale;
+		int m_width;
+		int m_height;
+		
+		size_t m_budget;
+		int m_lookahead;
+		
+		// index and rendering are not shared, taken before m_mutex
+		std::mutex m_renderMutex;
+		
+		std::mutex m_mutex;
+		std::condition_variable m_cond;
+		std::unordered_map<int, Entry> m_entries;
+		// most recently used first
+		std::list<int> m_ages;
+		std::deque<int> m_queue;
+		bool m_quit;
+		
+		std::atomic<size_t> m_bytes;
+		std::atomic<size_t> m_hits;
+		std::atomic<size_t> m_misses;
+		std::atomic<size_t> m_prefetched;
+		
+		std::thread m_worker;
+	};
+}
+
+#endif
@@ -0,0 +1,280 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "RenderIndex.hpp"
+
+#include <cmath>
+#include <limits>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	//tolerance of the first decimated level, each next one is 4 times coarser
+	const float BaseTolerance = 0.125f;
+	
+	//average segments per grid cell
+	const int CellLoad = 16;
+	
+	const int MaxCells = 64;
+	
+	void Reserve(LayerLevel& level, size_t count)
+	{
+		level.startX.reserve(count);
+		level.startY.reserve(count);
+		level.endX.reserve(count);
+		level.endY.reserve(count);
+		level.fill.reserve(count);
+	}
+	
+	void Push(LayerLevel& level, float x0, float y0, float x1, float y1, uint8_t fill)
+	{
+		level.startX.push_back(x0);
+		level.startY.push_back(y0);
+		level.endX.push_back(x1);
+		level.endY.push_back(y1);
+		level.fill.push_back(fill);
+	}
+	
+	/*
+		Radial distance simplification along chained runs of the same type,
+		points closer than tolerance to the last kept one are dropped
+	*/
+	void Decimate(const LayerLevel& source, LayerLevel& level)
+	{
+		float tolerance2 = level.tolerance * level.tolerance;
+		size_t count = source.Segments();
+		
+		Reserve(level, count);
+		
+		bool open = false;
+		bool pending = false;
+		uint8_t type = 0;
+		float keptX = 0.0f;
+		float keptY = 0.0f;
+		float lastX = 0.0f;
+		float lastY = 0.0f;
+		
+		for (size_t n = 0; n < count; n++) {
+			float x0 = source.startX[n];
+			float y0 = source.startY[n];
+			
+			bool chained = open and source.fill[n] == type and x0 == lastX and y0 == lastY;
+			
+			if (!chained) {
+				if (pending) {
+					Push(level, keptX, keptY, lastX, lastY, type);
+				}
+				
+				open = true;
+				type = source.fill[n];
+				keptX = x0;
+				keptY = y0;
+			}
+			
+			lastX = source.endX[n];
+			lastY = source.endY[n];
+			
+			float dx = lastX - keptX;
+			float dy = lastY - keptY;
+			
+			if (dx * dx + dy * dy >= tolerance2) {
+				Push(level, keptX, keptY, lastX, lastY, type);
+				keptX = lastX;
+				keptY = lastY;
+				pending = false;
+			}
+			else {
+				pending = true;
+			}
+		}
+		
+		if (pending) {
+			Push(level, keptX, keptY, lastX, lastY, type);
+		}
+	}
+	
+	void Bucket(const LayerIndex& index, LayerLevel& level)
+	{
+		size_t count = level.Segments();
+		int cells = index.columns * index.rows;
+		vector<int32_t> home(count);
+		
+		level.cells.assign(cells + 1, 0);
+		
+		for (size_t n = 0; n < count; n++) {
+			float x0 = level.startX[n];
+			float y0 = level.startY[n];
+			float x1 = level.endX[n];
+			float y1 = level.endY[n];
+			
+			if (fabs(x1 - x0) > index.cell or fabs(y1 - y0) > index.cell) {
+				home[n] = -1;
+				level.large.push_back(n);
+				continue;
+			}
+			
+			int c = (int)((0.5f * (x0 + x1) - index.bounds.left) / index.cell);
+			int r = (int)((0.5f * (y0 + y1) - index.bounds.top) / index.cell);
+			c = std::min(std::max(c, 0), index.columns - 1);
+			r = std::min(std::max(r, 0), index.rows - 1);
+			
+			home[n] = r * index.columns + c;
+			level.cells[home[n] + 1]++;
+		}
+		
+		for (int c = 0; c < cells; c++) {
+			level.cells[c + 1] += level.cells[c];
+		}
+		
+		level.items.resize(level.cells[cells]);
+		vector<uint32_t> next(level.cells.begin(), level.cells.end() - 1);
+		
+		for (size_t n = 0; n < count; n++) {
+			if (home[n] >= 0) {
+				level.items[next[home[n]]++] = n;
+			}
+		}
+	}
+}
+
+Bounds::Bounds() :
+left(numeric_limits<float>::max()),
+top(numeric_limits<float>::max()),
+right(-numeric_limits<float>::max()),
+bottom(-numeric_limits<float>::max())
+{
+}
+
+Bounds::Bounds(float left, float top, float right, float bottom) :
+left(left),
+top(top),
+right(right),
+bottom(bottom)
+{
+}
+
+void Bounds::Extend(float x, float y)
+{
+	left = std::min(left, x);
+	top = std::min(top, y);
+	right = std::max(right, x);
+	bottom = std::max(bottom, y);
+}
+
+LayerIndex::LayerIndex() : built(false), cell(1.0f), columns(1), rows(1)
+{
+}
+
+RenderIndex::RenderIndex() : m_render(nullptr)
+{
+}
+
+void RenderIndex::SetRender(const GRender* render)
+{
+	m_render = render;
+	m_layers.clear();
+	
+	if (m_render) {
+		m_layers.resize(m_render->Layers());
+	}
+}
+
+const LayerIndex& RenderIndex::Layer(int layer)
+{
+	LayerIndex& index = m_layers[layer];
+	
+	if (!index.built) {
+		BuildLayer(layer, index);
+	}
+	
+	return index;
+}
+
+void RenderIndex::Build()
+{
+	for (int n = 0; n < (int)m_layers.size(); n++) {
+		Layer(n);
+	}
+}
+
+void RenderIndex::BuildLayer(int layer, LayerIndex& index)
+{
+	size_t first = m_render->First(layer);
+	size_t last = m_render->Last(layer);
+	
+	index.levels.reserve(Levels);
+	index.levels.resize(1);
+	
+	LayerLevel& full = index.levels[0];
+	full.tolerance = 0.0f;
+	Reserve(full, last - first);
+	
+	for (size_t n = first; n < last; n++) {
+		Point start = m_render->Start(n);
+		Point end = m_render->End(n);
+		
+		index.bounds.Extend(start.x, start.y);
+		index.bounds.Extend(end.x, end.y);
+		
+		Push(full, start.x, start.y, end.x, end.y, m_render->Type(n) == SegmentType::Fill);
+	}
+	
+	//each level is simplified from the previous one, and only kept
+	//when it saves at least a quarter of the segments
+	LayerLevel level;
+	
+	for (int n = 1; n < Levels; n++) {
+		const LayerLevel& source = index.levels.back();
+		
+		level.tolerance = BaseTolerance * (1 << (2 * (n - 1)));
+		Decimate(source, level);
+		
+		if (level.Segments() * 4 <= source.Segments() * 3) {
+			index.levels.push_back(std::move(level));
+		}
+		
+		level = LayerLevel();
+	}
+	
+	if (index.bounds.Valid()) {
+		float width = index.bounds.right - index.bounds.left;
+		float height = index.bounds.bottom - index.bounds.top;
+		
+		//square cells, about CellLoad segments each
+		int cells = std::max(1, (int)(full.Segments() / CellLoad));
+		index.cell = std::max(sqrt(width * height / cells), std::max(width, height) / MaxCells);
+		index.cell = std::max(index.cell, 0.001f);
+		index.columns = std::min(MaxCells, (int)(width / index.cell) + 1);
+		index.rows = std::min(MaxCells, (int)(height / index.cell) + 1);
+	}
+	
+	for (LayerLevel& level : index.levels) {
+		Bucket(index, level);
+	}
+	
+	index.built = true;
+}
@@ -0,0 +1,198 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_RENDER_INDEX
+#define PC_RENDER_INDEX
+
+#include "GCode.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pc
+{
+	/*
+		Axis aligned box in mm
+	*/
+	class Bounds
+	{
+		public:
+		
+		float left;
+		float top;
+		float right;
+		float bottom;
+		
+		Bounds();
+		Bounds(float left, float top, float right, float bottom);
+		
+		void Extend(float x, float y);
+		
+		bool Valid() const
+		{
+			return left <= right and top <= bottom;
+		}
+		
+		bool Intersects(const Bounds& other) const
+		{
+			return left <= other.right and right >= other.left and top <= other.bottom and bottom >= other.top;
+		}
+	};
+	
+	/*
+		Segments of a layer at one level of detail, bucketed by the grid
+		cell holding their midpoint. Segments longer than a cell are kept
+		apart and always tested
+	*/
+	class LayerLevel
+	{
+		public:
+		
+		// max distance between a dropped point and the kept path
+		float tolerance;
+		
+		std::vector<float> startX;
+		std::vector<float> startY;
+		std::vector<float> endX;
+		std::vector<float> endY;
+		std::vector<uint8_t> fill;
+		
+		// segments in cell c are items[cells[c], cells[c + 1])
+		std::vector<uint32_t> cells;
+		std::vector<uint32_t> items;
+		std::vector<uint32_t> large;
+		
+		size_t Segments() const
+		{
+			return startX.size();
+		}
+	};
+	
+	class LayerIndex
+	{
+		public:
+		
+		LayerIndex();
+		
+		bool built;
+		Bounds bounds;
+		float cell;
+		int columns;
+		int rows;
+		std::vector<LayerLevel> levels;
+	};
+	
+	/*
+		Culling grid and decimated copies of every render layer, built on
+		first use of each layer
+	*/
+	class RenderIndex
+	{
+		public:
+		
+		// most levels of detail a layer may have
+		static const int Levels = 5;
+		
+		RenderIndex();
+		
+		void SetRender(const GRender* render);
+		
+		const LayerIndex& Layer(int layer);
+		
+		// builds every layer up front
+		void Build();
+		
+		// calls emit(start, end, type) for segments of layer that may be
+		// seen in view, at the coarsest detail finer than pixel mm
+		// returns how many were emitted
+		template <typename F>
+		size_t Visit(int layer, const Bounds& view, float pixel, F emit);
+		
+		protected:
+		
+		void BuildLayer(int layer, LayerIndex& index);
+		
+		const GRender* m_render;
+		std::vector<LayerIndex> m_layers;
+	};
+	
+	template <typename F>
+	size_t RenderIndex::Visit(int layer, const Bounds& view, float pixel, F emit)
+	{
+		const LayerIndex& index = Layer(layer);
+		
+		if (!index.bounds.Valid() or !index.bounds.Intersects(view)) {
+			return 0;
+		}
+		
+		int level = 0;
+		while (level + 1 < (int)index.levels.size() and index.levels[level + 1].tolerance <= pixel) {
+			level++;
+		}
+		
+		const LayerLevel& lod = index.levels[level];
+		size_t count = 0;
+		
+		auto Test = [&](uint32_t n) {
+			float x0 = lod.startX[n];
+			float y0 = lod.startY[n];
+			float x1 = lod.endX[n];
+			float y1 = lod.endY[n];
+			
+			Bounds box(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1));
+			
+			if (box.Intersects(view)) {
+				emit(Point(x0, y0), Point(x1, y1), lod.fill[n] ? SegmentType::Fill : SegmentType::Fly);
+				count++;
+			}
+		};
+		
+		//short segments reach at most half a cell out of their own
+		float margin = index.cell * 0.5f;
+		int c0 = std::max(0, (int)((view.left - margin - index.bounds.left) / index.cell));
+		int c1 = std::min(index.columns - 1, (int)((view.right + margin - index.bounds.left) / index.cell));
+		int r0 = std::max(0, (int)((view.top - margin - index.bounds.top) / index.cell));
+		int r1 = std::min(index.rows - 1, (int)((view.bottom + margin - index.bounds.top) / index.cell));
+		
+		for (int r = r0; r <= r1; r++) {
+			for (int c = c0; c <= c1; c++) {
+				int cell = r * index.columns + c;
+				
+				for (uint32_t i = lod.cells[cell]; i < lod.cells[cell + 1]; i++) {
+					Test(lod.items[i]);
+				}
+			}
+		}
+		
+		for (uint32_t n : lod.large) {
+			Test(n);
+		}
+		
+		return count;
+	}
+}
+
+#endif
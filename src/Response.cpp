@@ -0,0 +1,227 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "Response.hpp"
+
+#include <charconv>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	bool StartsWith(string_view in, string_view prefix)
+	{
+		return in.compare(0, prefix.size(), prefix) == 0;
+	}
+	
+	void SkipSpaces(string_view& in)
+	{
+		while (in.size() > 0 and in.front() == ' ') {
+			in.remove_prefix(1);
+		}
+	}
+	
+	bool Number(string_view& in, float& value)
+	{
+		from_chars_result result = from_chars(in.data(), in.data() + in.size(), value);
+		if (result.ec != errc()) {
+			return false;
+		}
+		
+		in.remove_prefix(result.ptr - in.data());
+		return true;
+	}
+	
+	/*
+		Name:value pairs, a value may be followed by /target.
+		T is the active hotend, T0 counts when there is no T
+	*/
+	void Temperatures(string_view in, Response& response)
+	{
+		while (true) {
+			SkipSpaces(in);
+			
+			size_t colon = in.find(':');
+			if (colon == string_view::npos) {
+				return;
+			}
+			
+			string_view name = in.substr(0, colon);
+			size_t space = name.rfind(' ');
+			if (space != string_view::npos) {
+				name.remove_prefix(space + 1);
+			}
+			in.remove_prefix(colon + 1);
+			
+			if (name == "W") {
+				response.fields |= FieldWait;
+				continue;
+			}
+			
+			float value;
+			float target;
+			if (!Number(in, value)) {
+				continue;
+			}
+			
+			bool hasTarget = false;
+			SkipSpaces(in);
+			if (in.size() > 0 and in.front() == '/') {
+				in.remove_prefix(1);
+				hasTarget = Number(in, target);
+			}
+			
+			if (name == "T" or (name == "T0" and !response.Has(FieldHotend))) {
+				response.hotend = value;
+				response.fields |= FieldHotend;
+				
+				if (hasTarget) {
+					response.hotendTarget = target;
+					response.fields |= FieldHotendTarget;
+				}
+			}
+			else if (name == "B") {
+				response.bed = value;
+				response.fields |= FieldBed;
+				
+				if (hasTarget) {
+					response.bedTarget = target;
+					response.fields |= FieldBedTarget;
+				}
+			}
+			else if (name == "@" or (name == "@0" and !response.Has(FieldHotendPower))) {
+				response.hotendPower = value;
+				response.fields |= FieldHotendPower;
+			}
+			else if (name == "B@") {
+				response.bedPower = value;
+				response.fields |= FieldBedPower;
+			}
+		}
+	}
+}
+
+void Response::Clear()
+{
+	type = ResponseType::Unknown;
+	ok = false;
+	resend = -1;
+	text = string_view();
+	fields = 0;
+	hotend = 0.0f;
+	hotendTarget = 0.0f;
+	bed = 0.0f;
+	bedTarget = 0.0f;
+	hotendPower = 0.0f;
+	bedPower = 0.0f;
+}
+
+void pc::ParseResponse(string_view in, Response& response)
+{
+	response.Clear();
+	
+	//message text keeps its line end, the rest does not need it
+	string_view raw = in;
+	
+	while (in.size() > 0 and (in.back() == '\n' or in.back() == '\r')) {
+		in.remove_suffix(1);
+	}
+	
+	//Marlin auto reports start with a space
+	SkipSpaces(in);
+	
+	auto Message = [&](ResponseType type, size_t skip) {
+		response.type = type;
+		response.text = raw.substr((in.data() - raw.data()) + skip);
+	};
+	
+	//"Resend: 12" from Marlin, "rs 12" from Repetier and RepRapFirmware
+	for (string_view prefix : {"Resend:", "rs "}) {
+		if (StartsWith(in, prefix)) {
+			in.remove_prefix(prefix.size());
+			SkipSpaces(in);
+			
+			int line;
+			if (from_chars(in.data(), in.data() + in.size(), line).ec == errc() and line >= 0) {
+				response.type = ResponseType::Resend;
+				response.resend = line;
+			}
+			
+			return;
+		}
+	}
+	
+	if (StartsWith(in, "ok") and (in.size() == 2 or in[2] == ' ')) {
+		response.ok = true;
+		response.type = ResponseType::Ok;
+		in.remove_prefix(2);
+	}
+	else if (StartsWith(in, "echo:busy:")) {
+		Message(ResponseType::Busy, 10);
+		return;
+	}
+	else if (StartsWith(in, "busy:")) {
+		Message(ResponseType::Busy, 5);
+		return;
+	}
+	else if (StartsWith(in, "echo:")) {
+		Message(ResponseType::Echo, 5);
+		return;
+	}
+	else if (StartsWith(in, "Error:")) {
+		Message(ResponseType::Error, 6);
+		return;
+	}
+	else if (StartsWith(in, "Warning:")) {
+		//RepRapFirmware, the word is part of the message
+		Message(ResponseType::Echo, 0);
+		return;
+	}
+	else if (StartsWith(in, "!!")) {
+		//Klipper
+		Message(ResponseType::Error, 2);
+		return;
+	}
+	else if (StartsWith(in, "Cap:")) {
+		//M115 answer, "Cap:AUTOREPORT_TEMP:1"
+		Message(ResponseType::Capability, 4);
+		return;
+	}
+	else if (StartsWith(in, "//")) {
+		//Klipper and host action messages
+		Message(ResponseType::Echo, 2);
+		return;
+	}
+	
+	//"ok T:..." answers M105, a bare report comes from auto reporting
+	if (in.find(':') != string_view::npos) {
+		Temperatures(in, response);
+		
+		if (response.fields != 0) {
+			response.type = ResponseType::Temperature;
+		}
+	}
+}
@@ -0,0 +1,101 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef PC_RESPONSE
+#define PC_RESPONSE
+
+#include <cstdint>
+#include <string_view>
+
+namespace pc
+{
+	enum class ResponseType
+	{
+		Unknown,
+		Ok,
+		Temperature,
+		Echo,
+		Error,
+		Resend,
+		Busy,
+		Capability
+	};
+	
+	// temperature report fields present in a response
+	enum ResponseField : uint32_t
+	{
+		FieldHotend = 1,
+		FieldHotendTarget = 2,
+		FieldBed = 4,
+		FieldBedTarget = 8,
+		FieldHotendPower = 16,
+		FieldBedPower = 32,
+		
+		// M109/M190 waiting for the temperature to settle, "W:5" or "W:?"
+		FieldWait = 64
+	};
+	
+	/*
+		One line received from the firmware, parsed in place
+	*/
+	class Response
+	{
+		public:
+		
+		ResponseType type;
+		
+		// acknowledges a command, also set on "ok T:..." reports
+		bool ok;
+		
+		// line number asked for again, or -1
+		int resend;
+		
+		// echo, error, busy or capability message, a view into the parsed line
+		std::string_view text;
+		
+		// ResponseField bits
+		uint32_t fields;
+		
+		// degrees, power in 0-127 as firmware reports it
+		float hotend;
+		float hotendTarget;
+		float bed;
+		float bedTarget;
+		float hotendPower;
+		float bedPower;
+		
+		void Clear();
+		
+		bool Has(ResponseField field) const
+		{
+			return (fields & field) != 0;
+		}
+	};
+	
+	// one pass, no allocation. Marlin, Klipper, RepRapFirmware and
+	// Repetier forms are understood
+	void ParseResponse(std::string_view in, Response& response);
+}
+
+#endif
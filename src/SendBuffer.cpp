@@ -0,0 +1,135 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "SendBuffer.hpp"
+
+#include <charconv>
+#include <cstring>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	//N, 10 digits, space, '*', 3 digits and newline
+	const size_t Overhead = 17;
+}
+
+SendBuffer::SendBuffer(size_t bytes, int lines)
+{
+	m_data.resize(bytes);
+	m_entries.resize(lines);
+	Clear();
+}
+
+void SendBuffer::Clear()
+{
+	for (Entry& entry : m_entries) {
+		entry.number = -1;
+	}
+	
+	m_position = 0;
+}
+
+void SendBuffer::Append(int number, string_view code, int fileLine)
+{
+	size_t capacity = m_data.size();
+	size_t size = code.size() + Overhead;
+	
+	if (size > capacity) {
+		code = code.substr(0, capacity - Overhead);
+		size = capacity;
+	}
+	
+	//lines never straddle the end of the ring
+	size_t offset = m_position % capacity;
+	if (offset + size > capacity) {
+		m_position += capacity - offset;
+		offset = 0;
+	}
+	
+	char* start = m_data.data() + offset;
+	char* p = start;
+	
+	*p++ = 'N';
+	p = to_chars(p, start + size, number).ptr;
+	*p++ = ' ';
+	memcpy(p, code.data(), code.size());
+	p += code.size();
+	
+	uint8_t checksum = 0;
+	for (char* c = start; c < p; c++) {
+		checksum ^= (uint8_t)*c;
+	}
+	
+	*p++ = '*';
+	p = to_chars(p, start + size, (int)checksum).ptr;
+	*p++ = '\n';
+	
+	Entry& entry = m_entries[number % m_entries.size()];
+	entry.number = number;
+	entry.fileLine = fileLine;
+	entry.position = m_position;
+	entry.size = p - start;
+	
+	m_position += entry.size;
+}
+
+bool SendBuffer::Get(int number, string_view& line) const
+{
+	if (number < 0) {
+		return false;
+	}
+	
+	const Entry& entry = m_entries[number % m_entries.size()];
+	
+	if (entry.number != number) {
+		return false;
+	}
+	
+	//bytes already reused by newer lines
+	if (entry.position + m_data.size() < m_position) {
+		return false;
+	}
+	
+	line = string_view(m_data.data() + (entry.position % m_data.size()), entry.size);
+	return true;
+}
+
+int SendBuffer::FileLine(int number) const
+{
+	if (number < 0) {
+		return -1;
+	}
+	
+	const Entry& entry = m_entries[number % m_entries.size()];
+	
+	if (entry.number != number) {
+		return -1;
+	}
+	
+	return entry.fileLine;
+}
@@ -0,0 +1,77 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef PC_SEND_BUFFER
+#define PC_SEND_BUFFER
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace pc
+{
+	/*
+		Numbered and checksummed lines, exactly as they go on the wire,
+		stored back to back in one ring of bytes. Holds both lines prepared
+		ahead of sending and recently sent ones kept for resends.
+		Oldest lines are overwritten as new ones are appended.
+	*/
+	class SendBuffer
+	{
+		public:
+		
+		SendBuffer(size_t bytes = 64 * 1024, int lines = 1024);
+		
+		void Clear();
+		
+		// prepares "N<number> <code>*<checksum>\n", code must not be empty
+		void Append(int number, std::string_view code, int fileLine);
+		
+		// false if the line has been overwritten or was never appended
+		bool Get(int number, std::string_view& line) const;
+		
+		// source file line of a stored line, or -1
+		int FileLine(int number) const;
+		
+		protected:
+		
+		struct Entry
+		{
+			int number;
+			int fileLine;
+			uint64_t position;
+			uint32_t size;
+		};
+		
+		std::vector<char> m_data;
+		std::vector<Entry> m_entries;
+		
+		// total bytes ever written, wraps into m_data
+		uint64_t m_position;
+	};
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#include "SendWindow.hpp"
+
+using namespace pc;
+
+using namespace std;
+
+SendWindow::SendWindow() : m_first(0), m_count(0), m_bytes(0), m_maxBytes(0)
+{
+	SetLimits(1, 0);
+}
+
+void SendWindow::SetLimits(int lines, size_t bytes)
+{
+	if (lines < 1) {
+		lines = 1;
+	}
+	
+	m_sizes.assign(lines, 0);
+	m_maxBytes = bytes;
+	Clear();
+}
+
+bool SendWindow::CanSend(size_t size) const
+{
+	//an empty window always accepts, or an oversized line would block forever
+	if (m_count == 0) {
+		return true;
+	}
+	
+	if (m_count >= (int)m_sizes.size()) {
+		return false;
+	}
+	
+	if (m_maxBytes > 0 and m_bytes + size > m_maxBytes) {
+		return false;
+	}
+	
+	return true;
+}
+
+void SendWindow::Push(size_t size)
+{
+	if (m_count >= (int)m_sizes.size()) {
+		return;
+	}
+	
+	int n = (m_first + m_count) % m_sizes.size();
+	m_sizes[n] = size;
+	m_count++;
+	m_bytes += size;
+}
+
+bool SendWindow::Pop()
+{
+	if (m_count == 0) {
+		return false;
+	}
+	
+	m_bytes -= m_sizes[m_first];
+	m_first = (m_first + 1) % m_sizes.size();
+	m_count--;
+	
+	return true;
+}
+
+void SendWindow::Clear()
+{
+	m_first = 0;
+	m_count = 0;
+	m_bytes = 0;
+}
@@ -0,0 +1,81 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef PC_SEND_WINDOW
+#define PC_SEND_WINDOW
+
+#include <cstddef>
+#include <vector>
+
+namespace pc
+{
+	/*
+		Lines sent but not yet acknowledged, bounded both by count and by
+		the bytes they take in the firmware receive buffer
+	*/
+	class SendWindow
+	{
+		public:
+		
+		SendWindow();
+		
+		void SetLimits(int lines, size_t bytes);
+		
+		// whether a line of given size can be sent now
+		bool CanSend(size_t size) const;
+		
+		void Push(size_t size);
+		
+		// oldest line has been acknowledged
+		bool Pop();
+		
+		void Clear();
+		
+		int Count() const
+		{
+			return m_count;
+		}
+		
+		size_t Bytes() const
+		{
+			return m_bytes;
+		}
+		
+		bool Empty() const
+		{
+			return m_count == 0;
+		}
+		
+		protected:
+		
+		std::vector<size_t> m_sizes;
+		int m_first;
+		int m_count;
+		size_t m_bytes;
+		size_t m_maxBytes;
+	};
+}
+
+#endif
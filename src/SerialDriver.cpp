@@ -25,6 +25,9 @@ SOFTWARE.
 #include "SerialDriver.hpp"
 #include "Messages.hpp"
 #include "Settings.hpp"
+#include "LineBuffer.hpp"
+#include "Response.hpp"
+#include "Logger.hpp"
 
 #include <String.h>
 #include <Path.h>
@@ -33,54 +36,29 @@ SOFTWARE.
 
 #include <iostream>
 #include <sstream>
-#include <map>
+#include <algorithm>
 
 using namespace pc;
 
 using namespace std;
 
 int32 _ReaderFunction(void* data);
-
-string prepare_line(int number,string line)
-{
-	string value;
-	stringstream ss;
-	bool valid=false;
-	
-	uint8 tmp = 0;
-	if (line.size() > 0) {
-		ss<<"N"<<number<<" ";
-		
-		for (size_t n=0;n<line.size();n++) {
-			uint8 c = line[n];
-			if (c == ';') {
-				break;
-			}
-			valid=true;
-			ss<<c;
-			//tmp = tmp xor c;
-		}
-		
-		line = ss.str();
-		for (size_t n=0;n<line.size();n++) {
-			uint8 c = line[n];
-			tmp = tmp xor c;
-		}
-		ss<<"*"<<(int)tmp<<"\n";
-	}
-	
-	if (!valid) {
-		return "";
-	}
-	return ss.str();
-}
+int32 _ParserFunction(void* data);
 
 SerialDriver::SerialDriver(BLooper* callback) : 
 m_cb(callback), 
 connected(false),
-printStatus(PrintStatus::Off),
-printLine(0)
+fCacheSize(0),
+fParserThread(-1),
+fPreviewReady(0),
+fPreviewGeneration(0),
+printStatus(PrintStatus::Off)
 {
+	m_gcode.SetCache(&fCache);
+	
+	//same period as the M105 fallback below
+	SetAutoReport(1);
+	
 	messenger = BMessenger(nullptr,this);
 	messageQuery = new BMessage(Message::QueryInfo);
 	messageRunner = new BMessageRunner(messenger, messageQuery, 1000000);
@@ -109,19 +87,79 @@ void SerialDriver::MessageReceived(BMessage* message)
 {
 	switch(message->what) {
 		case Message::LoadFile: {
-			//ToDo: parse file
+			if (printStatus == PrintStatus::Running or printStatus == PrintStatus::Paused) {
+				PushEcho("Cannot open a file while printing\n");
+				break;
+			}
+			
 			entry_ref ref;
 			message->FindRef("ref", 0, &ref);
 			BEntry entry(&ref, true);
 			BPath path;
 			entry.GetPath(&path);
-			clog<<"parsing "<<path.Path()<<endl;
-			m_gcode.LoadFile(path.Path());
-			clog<<"lines:"<<m_gcode.Lines()<<endl;
-			clog<<"height:"<<m_gcode.Height()<<endl;
-			clog<<"layers:"<<m_gcode.Layers()<<endl;
-			clog<<"filament:"<<m_gcode.Filament()<<endl;
-			m_cb->PostMessage(Message::FileLoaded);
+			
+			//a previous preview may still be parsing
+			if (fParserThread >= 0) {
+				status_t result;
+				wait_for_thread(fParserThread, &result);
+				fParserThread = -1;
+			}
+			atomic_set(&fPreviewReady, 0);
+			
+			//safe now that no parser is running
+			fCache.SetDirectory(fCacheDir);
+			fCache.SetLimit((uint64)fCacheSize << 20);
+			
+			if (!Open(path.Path())) {
+				PushEcho("Failed to open file\n");
+				break;
+			}
+			
+			fFilename = path.Path();
+			printStatus = PrintStatus::Off;
+			fPreviewGeneration++;
+			
+			//parsing starts once the window lets go of the old render
+			BMessage* opened = new BMessage(Message::FileOpened);
+			opened->AddInt32("generation",fPreviewGeneration);
+			m_cb->PostMessage(opened);
+			}
+		break;
+		
+		case Message::PreviewReleased:
+			//a later file may have been opened meanwhile
+			if (message->FindInt32("generation") != fPreviewGeneration or fParserThread >= 0) {
+				break;
+			}
+			
+			//preview is not needed to start printing
+			fParserThread = spawn_thread(_ParserFunction, "parserThread", B_LOW_PRIORITY, (void*)this);
+			resume_thread(fParserThread);
+		break;
+		
+		case Message::Cache: {
+			BString dir;
+			message->FindString("cachedir",&dir);
+			fCacheDir = dir.String();
+			message->FindInt32("cachesize",&fCacheSize);
+			}
+		break;
+		
+		case Message::Run:
+			if (printStatus == PrintStatus::Off and IsOpen()) {
+				if (!connected) {
+					PushEcho("Not connected\n");
+					break;
+				}
+				
+				//numbering was not reset, N1 would be refused
+				if (!Start()) {
+					PushEcho("Printer is not responding\n");
+					break;
+				}
+				
+				printStatus = PrintStatus::Running;
+				PostMessage(Message::PrintStep);
 			}
 		break;
 
@@ -207,34 +245,50 @@ void SerialDriver::MessageReceived(BMessage* message)
 	
 			//baud rate
 			settings->FindInt32("baudrate",&value);
-			clog<<"baudrate "<<value<<endl;
+			PC_LOG(LogLevel::Debug)<<"baudrate "<<value;
 			device.SetDataRate((data_rate)value);
 			
 			//parity
 			settings->FindInt32("parity",&value);
-			clog<<"parity "<<value<<endl;
+			PC_LOG(LogLevel::Debug)<<"parity "<<value;
 			device.SetParityMode((parity_mode)value);
 			
 			//stop
 			settings->FindInt32("stop",&value);
-			clog<<"stop "<<value<<endl;
+			PC_LOG(LogLevel::Debug)<<"stop "<<value;
 			device.SetStopBits((stop_bits)value);
 			
 			//flow
 			settings->FindInt32("flow",&value);
-			clog<<"flow "<<value<<endl;	
+			PC_LOG(LogLevel::Debug)<<"flow "<<value;	
 			device.SetFlowControl(value);
 			
 			//databits
 			settings->FindInt32("databits",&value);
-			clog<<"databits "<<value<<endl;
+			PC_LOG(LogLevel::Debug)<<"databits "<<value;
 			device.SetDataBits((data_bits)value);
 			
+			//send mode
+			if (settings->FindInt32("protocol",&value) != B_OK) {
+				value = (int32)SendMode::PingPong;
+			}
+			PC_LOG(LogLevel::Debug)<<"protocol "<<value;
+			
+			int32 inflight = 1;
+			int32 rxbuffer = 0;
+			settings->FindInt32("inflight",&inflight);
+			settings->FindInt32("rxbuffer",&rxbuffer);
+			PC_LOG(LogLevel::Debug)<<"window "<<inflight<<" lines, "<<rxbuffer<<" bytes";
+			SetMode((SendMode)value,inflight,rxbuffer);
+			
 			device.SetBlocking(false);
 			device.SetTimeout(250000);
 			
 			status_t status = device.Open(path);
 			if (status > 0) {
+				//a new session, even after an emergency stop
+				Reset();
+				
 				connected = true;
 				accepted = true;
 				
@@ -255,7 +309,8 @@ void SerialDriver::MessageReceived(BMessage* message)
 		break;
 		
 		case Message::QueryInfo:
-			if (connected and printStatus == PrintStatus::Running) {
+			//only when firmware cannot report on its own
+			if (connected and printStatus == PrintStatus::Running and !AutoReporting()) {
 				Exec("M105");
 			}
 		break;
@@ -269,32 +324,49 @@ void SerialDriver::MessageReceived(BMessage* message)
 		case Message::PrintStep: {
 			
 			if (printStatus != PrintStatus::Running) {
+				Drain();
+				
+				//commands queued while the last step was running
+				if (!ExecQueued()) {
+					PushEcho("Printer is not responding\n");
+				}
 				break;
 			}
 			
-			if (readLine >= m_gcode.Lines()) {
-				printStatus = PrintStatus::Ended;
+			switch (Step()) {
+				case StepResult::Continue:
+					PostMessage(Message::PrintStep);
 				break;
-			}
-			
-			string code = m_gcode.Line(readLine);
-			code = prepare_line(printLine+1,code);
-			if (code.size() == 0) {
-				readLine++;
-				PostMessage(Message::PrintStep);
+				
+				case StepResult::Ended:
+					printStatus = PrintStatus::Ended;
+				break;
+				
+				case StepResult::NoResponse:
+					PushEcho("Printer is not responding, print paused\n");
+					printStatus = PrintStatus::Paused;
+				break;
+				
+				case StepResult::Lost:
+					PushEcho("Cannot resend line " + to_string(LostLine()) + ", print paused\n");
+					printStatus = PrintStatus::Paused;
+				break;
+				
+				case StepResult::Halted:
+					PushEcho("Emergency stop, print ended\n");
+					printStatus = PrintStatus::Ended;
 				break;
 			}
-			clog<<code;
-			Send(code);
-			PopOk();
-			
-			printLine++;
-			readLine++;
-			
-			PostMessage(Message::PrintStep);
 		}
 		break;
 		
+		case Message::Exec:
+			//a running job sends them from Step
+			if (printStatus != PrintStatus::Running and !ExecQueued()) {
+				PushEcho("Printer is not responding\n");
+			}
+		break;
+		
 		case Message::UpdateVariables:
 			m_cb->PostMessage(message);
 		break;
@@ -336,11 +408,39 @@ void SerialDriver::LoadFile(string filename)
 	PostMessage(message);
 }
 
+void SerialDriver::SetCache(BMessage* settings)
+{
+	BMessage* msg = new BMessage(Message::Cache);
+	msg->AddString("cachedir",settings->FindString("cachedir"));
+	msg->AddInt32("cachesize",settings->FindInt32("cachesize"));
+	PostMessage(msg);
+}
+
+void SerialDriver::LoadPreview()
+{
+	PC_LOG(LogLevel::Debug)<<"parsing "<<fFilename;
+	bigtime_t start = system_time();
+	m_gcode.LoadFile(fFilename.c_str());
+	bigtime_t elapsed = system_time() - start;
+	PC_LOG(LogLevel::Info)<<"lines:"<<m_gcode.Lines();
+	PC_LOG(LogLevel::Info)<<"height:"<<m_gcode.Height();
+	PC_LOG(LogLevel::Info)<<"layers:"<<m_gcode.Layers();
+	PC_LOG(LogLevel::Info)<<"filament:"<<m_gcode.Filament();
+	PC_LOG(LogLevel::Info)<<"time:"<<m_gcode.PrintTime();
+	PC_LOG(LogLevel::Info)<<(m_gcode.FromCache() ? "warm" : "cold")<<" open:"<<elapsed<<"us";
+	
+	atomic_set(&fPreviewReady, 1);
+	
+	BMessage* msg = new BMessage(Message::FileLoaded);
+	msg->AddInt64("elapsed",elapsed);
+	msg->AddBool("cached",m_gcode.FromCache());
+	m_cb->PostMessage(msg);
+}
+
 void SerialDriver::Exec(string line)
 {
-	clog<<"command:"<<line<<endl;
-	Send(line + "\n");
-	PopOk();
+	Queue(line);
+	PostMessage(Message::Exec);
 }
 
 void SerialDriver::Home(uint8 axis)
@@ -401,13 +501,8 @@ void SerialDriver::DisableSteppers()
 
 void SerialDriver::PrintRun()
 {
-	if (printStatus == PrintStatus::Off) {
-		printStatus = PrintStatus::Running;
-		//Exec("M110 N1");
-		printLine = 0;
-		readLine = 0;
-		PostMessage(Message::PrintStep);
-	}
+	//Exec("M110 N1");
+	PostMessage(Message::Run);
 }
 
 void SerialDriver::PrintPause()
@@ -423,58 +518,24 @@ void SerialDriver::PrintStop()
 void SerialDriver::PrintRestart()
 {
 	printStatus = PrintStatus::Off;
-	PrintRun();
+	PostMessage(Message::Run);
 }
 
-void SerialDriver::Send(string line)
+void SerialDriver::Send(string_view line)
 {
-	string buffer;
+	const char* data = line.data();
+	size_t pending = line.size();
 	
-	for (char c:line) {
-		//strip comments from lines
-		if (c == ';') {
-			continue;
+	while (pending > 0) {
+		ssize_t size = device.Write((const void *)data,pending);
+		if (size<=0) {
+			cerr<<"Output error:"<<size<<endl;
+			return;
 		}
 		
-		buffer = buffer + c;
-	}
-	
-	size_t size = device.Write((const void *)buffer.c_str(),buffer.size());
-	if (size<=0) {
-		cerr<<"Output error:"<<size<<endl;
-		return;
+		data += size;
+		pending -= size;
 	}
-	
-}
-
-void SerialDriver::PushOk()
-{
-	atomic_add(&okCount,1);
-}
-
-void SerialDriver::PopOk()
-{
-	int32 value = 0;
-	
-	while (true) {
-		value = atomic_get(&okCount);
-		
-		if (value <= 0) {
-			
-			snooze(500); //500 us (0.5 ms)
-		}
-		else {
-			atomic_add(&okCount,-1);
-			break;
-		}
-	}
-}
-
-void SerialDriver::ResetOk()
-{
-	Lock();
-	okCount = 0;
-	Unlock();
 }
 
 void SerialDriver::PushEcho(string text)
@@ -484,112 +545,93 @@ void SerialDriver::PushEcho(string text)
 	m_cb->PostMessage(msg);
 }
 
-uint32 _ProcessInput(SerialDriver* driver, string in)
+uint32 _ProcessInput(SerialDriver* driver, string_view in)
 {
-	string token;
-	string cmd;
-	string value;
-	map<string,float> vars;
-	
-	bool echo = false;
-	bool ok = false;
+	Response response;
+	driver->Receive(in, response);
 	
-	for (char c:in) {
-	
-		if (echo) {
-			token.push_back(c);
-			continue;
-		}
+	switch (response.type) {
+		case ResponseType::Echo:
+			PC_LOG(LogLevel::Debug)<<response.text;
+			driver->PushEcho(string(response.text));
+		break;
 		
-		switch(c) {
-			case ' ':
-			case '\n':
-				if (token.size() == 0) {
-					continue;
-				}
-				else {
-					
-					if (token == "ok") {
-						ok = true;
-						clog<<"ok!"<<endl;
-					}
-					
-					if (cmd.size() > 0) {
-						clog<<cmd<<"="<<token<<endl;
-						
-						try {
-							vars[cmd] = std::stof(token);
-						}
-						catch(...) {
-							//for now, just ignore bad parsed floats
-						}
-					}
-					
-					token.clear();
-					cmd.clear();
-				}
-			break;
+		case ResponseType::Error:
+			PC_LOG(LogLevel::Warning)<<"Error:"<<response.text;
+			driver->PushEcho("Error:" + string(response.text));
+		break;
+		
+		case ResponseType::Temperature: {
+			BMessage* msg = new BMessage(Message::UpdateVariables);
 			
-			case ':':
-				cmd = token;
-				token.clear();
-				
-				if (cmd == "echo") {
-					echo = true;
-				}
-			break;
+			if (response.Has(FieldHotend)) {
+				msg->AddFloat("hotend",response.hotend);
+			}
+			if (response.Has(FieldHotendTarget)) {
+				msg->AddFloat("hotend target",response.hotendTarget);
+			}
+			if (response.Has(FieldBed)) {
+				msg->AddFloat("bed",response.bed);
+			}
+			if (response.Has(FieldBedTarget)) {
+				msg->AddFloat("bed target",response.bedTarget);
+			}
+			if (response.Has(FieldHotendPower)) {
+				msg->AddFloat("hotend power",response.hotendPower);
+			}
+			if (response.Has(FieldBedPower)) {
+				msg->AddFloat("bed power",response.bedPower);
+			}
 			
-			default:
-				token.push_back(c);
+			driver->PostMessage(msg);
 		}
-	
-	}
-	
-	if (echo) {
-		clog<<token;
-		driver->PushEcho(token);
-	}
-	
-	if (ok) {
-		driver->PushOk();
-	}
-	
-	if (vars.size() > 0) {
-		BMessage* msg = new BMessage(Message::UpdateVariables);
+		break;
 		
-		for (auto & item  : vars) {
-			msg->AddFloat(item.first.c_str(),item.second);
-		}
-		driver->PostMessage(msg);
+		default:
+		break;
 	}
 	
 	return 0;
 }
 
+int32 _ParserFunction(void* data)
+{
+	SerialDriver* driver = (SerialDriver *) data;
+	driver->LoadPreview();
+	
+	return 0;
+}
+
 int32 _ReaderFunction(void* data)
 {
-	clog<<"Reader Thread"<<endl;
+	PC_LOG(LogLevel::Debug)<<"Reader Thread";
 	
 	SerialDriver* driver = (SerialDriver *) data;
 	BSerialPort* device = driver->Device();
 	
-	uint8 buffer;
-	string line;
-	size_t size;
+	LineBuffer input;
+	string_view line;
 	
 	while (true) {
-		size = device->Read((void *)&buffer,1);
+		ssize_t size = device->Read((void *)input.Space(),input.Free());
 		
-		if (size<=0) {
+		if (size < 0) {
 			break;
 		}
 		
-		line+=buffer;
+		//read timed out
+		if (size == 0) {
+			if (!driver->IsConnected()) {
+				break;
+			}
+			continue;
+		}
+		
+		input.Commit(size);
 		
-		if (buffer == '\n') {
-			clog<<"<<"<<line<<endl;
+		while (input.Next(line)) {
+			PC_LOG(LogLevel::Trace)<<"<<"<<line;
 			_ProcessInput(driver, line);
-			line.clear();
 		}
 	}
 	
@@ -26,6 +26,7 @@ SOFTWARE.
 #define PC_SERIAL_DRIVER
 
 #include "GCode.hpp"
+#include "Protocol.hpp"
 
 #include <Looper.h>
 #include <SerialPort.h>
@@ -33,6 +34,7 @@ SOFTWARE.
 #include <MessageRunner.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace pc
@@ -44,7 +46,7 @@ namespace pc
 		Ended
 	};
 	
-	class SerialDriver : public BLooper
+	class SerialDriver : public BLooper, public Protocol
 	{
 		public:
 
@@ -73,8 +75,13 @@ namespace pc
 			return printStatus;
 		}
 		
+		// preview cache folder and size from settings
+		void SetCache(BMessage* settings);
+		
 		void LoadFile(std::string filename);
+		void LoadPreview();
 
+		// queued, safe from any thread, see Protocol::Queue
 		void Exec(std::string line);
 		void Home(uint8 axis);
 		void Fan(uint8 fan,uint8 speed);
@@ -100,30 +107,26 @@ namespace pc
 		
 		
 
-		void Send(std::string line);
-		
-		void PushOk();
-		void PopOk();
-		void ResetOk();
+		void Send(std::string_view line) override;
 		
 		void PushEcho(std::string text);
 		
+		// zero until the background preview parse is done
 		int Lines()
 		{
+			if (atomic_get(&fPreviewReady) == 0) {
+				return 0;
+			}
 			return m_gcode.Lines();
 		}
 		
-		int CurrentLine()
-		{
-			return readLine;
-		}
-		
 		pc::GCode& GCode()
 		{
 			return m_gcode;
 		}
 		
 		protected:
+		
 		BMessenger messenger;
 		BMessageRunner* messageRunner;
 		BMessage* messageQuery;
@@ -134,16 +137,20 @@ namespace pc
 		std::string devicePath;
 		
 		pc::GCode m_gcode;
+		PreviewCache fCache;
+		std::string fCacheDir;
+		int32 fCacheSize;
+		std::string fFilename;
 		
-		bool accepted;
+		thread_id fParserThread;
+		int32 fPreviewReady;
+		int32 fPreviewGeneration;
 		
-		int32 okCount;
+		bool accepted;
 		
 		thread_id fReaderThread;
 		
 		PrintStatus printStatus;
-		int printLine;
-		int readLine;
 	};
 
 }
@@ -57,7 +57,21 @@ map<string,int32> values = {
 	{"flow.Both", B_SOFTWARE_CONTROL | B_HARDWARE_CONTROL},
 	{"flow.None", 0},
 	{"databits.7", B_DATA_BITS_7},
-	{"databits.8", B_DATA_BITS_8}
+	{"databits.8", B_DATA_BITS_8},
+	{"protocol.Ping-pong", 0},
+	{"protocol.Window", 1},
+	{"inflight.2", 2},
+	{"inflight.4", 4},
+	{"inflight.8", 8},
+	{"inflight.16", 16},
+	{"rxbuffer.63", 63},
+	{"rxbuffer.127", 127},
+	{"rxbuffer.255", 255},
+	{"rxbuffer.511", 511},
+	{"cachesize.Off", 0},
+	{"cachesize.64 MB", 64},
+	{"cachesize.256 MB", 256},
+	{"cachesize.1024 MB", 1024}
 };
 
 void Settings::Save(BMessage* settings)
@@ -113,6 +127,30 @@ BMessage* Settings::Load()
 		Settings::Save(settings);
 	}
 	
+	//fields missing from settings saved by older versions
+	if (!settings->HasInt32("protocol")) {
+		settings->AddInt32("protocol",Value("protocol","Ping-pong"));
+	}
+	
+	if (!settings->HasInt32("inflight")) {
+		settings->AddInt32("inflight",Value("inflight","4"));
+	}
+	
+	if (!settings->HasInt32("rxbuffer")) {
+		settings->AddInt32("rxbuffer",Value("rxbuffer","127"));
+	}
+	
+	if (!settings->HasInt32("cachesize")) {
+		settings->AddInt32("cachesize",Value("cachesize","256 MB"));
+	}
+	
+	if (!settings->HasString("cachedir")) {
+		BPath cache;
+		find_directory(B_USER_CACHE_DIRECTORY,&cache);
+		cache.Append("PrintControl");
+		settings->AddString("cachedir",cache.Path());
+	}
+	
 	return settings;
 }
 
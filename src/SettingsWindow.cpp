@@ -97,6 +97,45 @@ SettingsWindow::SettingsWindow(BWindow* parent, BMessage* settings)
 	popMenu->FindItem(Settings::Name("databits",value).c_str())->SetMarked(true);
 	BMenuField* fieldDatabits = new BMenuField("databits","Data bits", popMenu);
 	
+	popMenu = new BPopUpMenu("data");
+	vector<string> protocolValues = Settings::Section("protocol");
+	for (string value:protocolValues) {
+		popMenu->AddItem(new BMenuItem(value.c_str(),new BMessage(Message::SettingsChanged)));
+	}
+	settings->FindInt32("protocol",&value);
+	popMenu->FindItem(Settings::Name("protocol",value).c_str())->SetMarked(true);
+	BMenuField* fieldProtocol = new BMenuField("protocol","Send mode", popMenu);
+	
+	popMenu = new BPopUpMenu("data");
+	vector<string> inflightValues = Settings::Section("inflight");
+	for (string value:inflightValues) {
+		popMenu->AddItem(new BMenuItem(value.c_str(),new BMessage(Message::SettingsChanged)));
+	}
+	settings->FindInt32("inflight",&value);
+	popMenu->FindItem(Settings::Name("inflight",value).c_str())->SetMarked(true);
+	BMenuField* fieldInflight = new BMenuField("inflight","Lines in flight", popMenu);
+	
+	popMenu = new BPopUpMenu("data");
+	vector<string> rxbufferValues = Settings::Section("rxbuffer");
+	for (string value:rxbufferValues) {
+		popMenu->AddItem(new BMenuItem(value.c_str(),new BMessage(Message::SettingsChanged)));
+	}
+	settings->FindInt32("rxbuffer",&value);
+	popMenu->FindItem(Settings::Name("rxbuffer",value).c_str())->SetMarked(true);
+	BMenuField* fieldRxbuffer = new BMenuField("rxbuffer","RX buffer bytes", popMenu);
+	
+	popMenu = new BPopUpMenu("data");
+	vector<string> cachesizeValues = Settings::Section("cachesize");
+	for (string value:cachesizeValues) {
+		popMenu->AddItem(new BMenuItem(value.c_str(),new BMessage(Message::SettingsChanged)));
+	}
+	settings->FindInt32("cachesize",&value);
+	popMenu->FindItem(Settings::Name("cachesize",value).c_str())->SetMarked(true);
+	BMenuField* fieldCachesize = new BMenuField("cachesize","Preview cache size", popMenu);
+	
+	BTextControl* fieldCachedir = new BTextControl("cachedir","Preview cache folder",
+		settings->FindString("cachedir"),new BMessage(Message::SettingsChanged));
+	
 	fBtnOk = new BButton("Ok", new BMessage(Message::SettingsClose));
 	fBtnOk->SetEnabled(false);
 	
@@ -107,7 +146,12 @@ SettingsWindow::SettingsWindow(BWindow* parent, BMessage* settings)
 		.Add(fieldStop, 1, 3)
 		.Add(fieldFlow, 1, 4)
 		.Add(fieldDatabits, 1, 5)
-		.Add(fBtnOk, 2, 10);
+		.Add(fieldProtocol, 1, 6)
+		.Add(fieldInflight, 1, 7)
+		.Add(fieldRxbuffer, 1, 8)
+		.Add(fieldCachesize, 1, 9)
+		.Add(fieldCachedir, 1, 10)
+		.Add(fBtnOk, 2, 12);
 	
 }
 
@@ -129,7 +173,7 @@ void SettingsWindow::MessageReceived(BMessage* message)
 			clog<<"closing settings..."<<endl;
 			BMessage* msg = new BMessage(Message::Settings);
 			
-			vector<string> options = {"baudrate","parity","stop","flow","databits"};
+			vector<string> options = {"baudrate","parity","stop","flow","databits","protocol","inflight","rxbuffer","cachesize"};
 			
 			for (string option:options) {
 				BMenuField* field = static_cast<BMenuField*>(FindView(option.c_str()));
@@ -137,6 +181,9 @@ void SettingsWindow::MessageReceived(BMessage* message)
 			
 			}
 			
+			BTextControl* cachedir = static_cast<BTextControl*>(FindView("cachedir"));
+			msg->AddString("cachedir",cachedir->Text());
+			
 			fParent->PostMessage(msg);
 			//SettingsWindow::SaveSettings(msg);
 			//delete msg;
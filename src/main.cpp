@@ -23,7 +23,9 @@ SOFTWARE.
 */
 
 #include "PrintControl.hpp"
+#include "Logger.hpp"
 
+#include <cstdlib>
 #include <iostream>
 
 using namespace pc;
@@ -32,6 +34,18 @@ using namespace std;
 
 int main (int argc,char* argv[])
 {
+	//PC_LOG=trace|debug|info|warning|error|off
+	const char* level = getenv("PC_LOG");
+	if (level) {
+		Logger::SetLevel(level);
+	}
+	
+	//rotated at 16 MB, three old files kept
+	const char* file = getenv("PC_LOG_FILE");
+	if (file) {
+		Logger::SetFile(file, 16 * 1024 * 1024, 3);
+	}
+	
 	PrintControl* app = new PrintControl();
 	app->Run();
 	
@@ -0,0 +1,134 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Streams three simulated hours of firmware echo into a ConsoleBuffer
+	the size MainWindow uses, flushing at the window rate into a mirror
+	string. Fails if the buffer grows past its limits, allocates after
+	warming up, or the mirror drifts from the buffer text
+*/
+
+#include "ConsoleBuffer.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	const size_t MaxBytes = 1024 * 1024;
+	const size_t MaxLines = 10000;
+	
+	//three hours at 200 lines per second, 10 flushes per second
+	const long Rate = 200;
+	const long Total = 3 * 3600 * Rate;
+	const long FlushEvery = Rate / 10;
+	const long CheckEvery = Rate * 600;
+	
+	/*
+		Exposes the storage the buffer allocated
+	*/
+	class Probe : public ConsoleBuffer
+	{
+		public:
+		
+		Probe() : ConsoleBuffer(MaxBytes, MaxLines)
+		{
+		}
+		
+		size_t Allocated() const
+		{
+			return m_data.capacity() + m_lines.capacity() * sizeof(uint32_t);
+		}
+	};
+	
+	int failures = 0;
+	
+	void Check(bool condition, const char* what, long line)
+	{
+		if (!condition) {
+			cerr<<"FAIL "<<what<<" after "<<line<<" lines"<<endl;
+			failures++;
+		}
+	}
+}
+
+int main()
+{
+	Probe buffer;
+	mt19937 random(1);
+	
+	size_t allocated = buffer.Allocated();
+	string view;
+	string appended;
+	size_t dropped;
+	
+	for (long n = 0; n < Total and failures == 0; n++) {
+		string text = "echo:busy: processing line " + to_string(n);
+		
+		//now and then a huge line, longer ones than the whole buffer too
+		if (random() % 100000 == 0) {
+			text = string(5000 + random() % (2 * MaxBytes), 'x');
+		}
+		
+		if (random() % 3 != 0) {
+			text += '\n';
+		}
+		
+		//serial reads split lines anywhere
+		size_t cut = random() % (text.size() + 1);
+		buffer.Append(string_view(text).substr(0, cut));
+		buffer.Append(string_view(text).substr(cut));
+		
+		Check(buffer.Bytes() <= MaxBytes, "byte limit", n);
+		Check(buffer.Lines() <= MaxLines + 1, "line limit", n);
+		Check(buffer.Allocated() == allocated, "constant storage", n);
+		
+		if (n % FlushEvery == 0 and buffer.Flush(dropped, appended)) {
+			Check(dropped <= view.size(), "dropped bytes", n);
+			view.erase(0, dropped);
+			view += appended;
+		}
+		
+		if (n % CheckEvery == 0) {
+			Check(view == buffer.Text(), "view follows buffer", n);
+			cout<<"minute="<<n / Rate / 60<<" bytes="<<buffer.Bytes()<<" lines="<<buffer.Lines()<<endl;
+		}
+	}
+	
+	if (buffer.Flush(dropped, appended)) {
+		view.erase(0, dropped);
+		view += appended;
+	}
+	Check(view == buffer.Text(), "final view", Total);
+	
+	cout<<"lines="<<Total<<" storage bytes="<<buffer.Allocated()<<" failures="<<failures<<endl;
+	
+	return (failures == 0) ? 0 : 1;
+}
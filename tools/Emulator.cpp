@@ -0,0 +1,440 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/*
+	Marlin-like printer firmware on a pseudo terminal, for exercising the
+	serial driver without hardware. Prints the terminal path and serves
+	until interrupted, then reports what it received.
+*/
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <getopt.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	volatile sig_atomic_t quit = 0;
+	
+	void OnSignal(int)
+	{
+		quit = 1;
+	}
+	
+	bool Number(string_view text, char letter, int& value)
+	{
+		size_t n = text.find(letter);
+		if (n == string_view::npos) {
+			return false;
+		}
+		
+		const char* p = text.data() + n + 1;
+		return from_chars(p, text.data() + text.size(), value).ec == errc();
+	}
+}
+
+class Emulator
+{
+	public:
+	
+	Emulator() :
+	m_delay(0),
+	m_rxBuffer(128),
+	m_errorRate(0.0),
+	m_fd(-1),
+	m_lastLine(0),
+	m_autoReport(0),
+	m_rxBytes(0),
+	m_busy(false),
+	m_commands(0),
+	m_errors(0),
+	m_overflows(0),
+	m_latency(0)
+	{
+	}
+	
+	bool Open(const char* link);
+	void Run();
+	void Report();
+	
+	// per command processing time in microseconds
+	int m_delay;
+	size_t m_rxBuffer;
+	double m_errorRate;
+	
+	protected:
+	
+	void Write(string_view text);
+	void Receive();
+	void Process(string_view line);
+	void Execute(string_view code);
+	string Temperatures();
+	
+	int m_fd;
+	int m_lastLine;
+	int m_autoReport;
+	
+	//received bytes not yet taken by the command parser
+	deque<char> m_rx;
+	size_t m_rxBytes;
+	
+	//when the newline of each buffered line was read
+	deque<Clock::time_point> m_arrivals;
+	
+	bool m_busy;
+	string m_current;
+	Clock::time_point m_received;
+	Clock::time_point m_done;
+	Clock::time_point m_report;
+	Clock::time_point m_start;
+	
+	mt19937 m_random;
+	
+	long m_commands;
+	long m_errors;
+	long m_overflows;
+	double m_latency;
+};
+
+bool Emulator::Open(const char* link)
+{
+	m_fd = posix_openpt(O_RDWR | O_NOCTTY);
+	if (m_fd < 0 or grantpt(m_fd) < 0 or unlockpt(m_fd) < 0) {
+		cerr<<"Failed to create pseudo terminal"<<endl;
+		return false;
+	}
+	
+	const char* name = ptsname(m_fd);
+	
+	//raw mode, so the driver gets bytes as they are written
+	int slave = open(name, O_RDWR | O_NOCTTY);
+	if (slave >= 0) {
+		termios tio;
+		tcgetattr(slave, &tio);
+		cfmakeraw(&tio);
+		tcsetattr(slave, TCSANOW, &tio);
+		close(slave);
+	}
+	
+	if (link) {
+		unlink(link);
+		if (symlink(name, link) < 0) {
+			cerr<<"Failed to link "<<link<<endl;
+		}
+		name = link;
+	}
+	
+	cout<<name<<endl;
+	
+	m_start = Clock::now();
+	m_report = m_start;
+	
+	Write("start\n");
+	
+	return true;
+}
+
+void Emulator::Write(string_view text)
+{
+	while (text.size() > 0) {
+		ssize_t size = write(m_fd, text.data(), text.size());
+		if (size <= 0) {
+			return;
+		}
+		text.remove_prefix(size);
+	}
+}
+
+void Emulator::Receive()
+{
+	char buffer[1024];
+	ssize_t size = read(m_fd, buffer, sizeof(buffer));
+	Clock::time_point now = Clock::now();
+	
+	for (ssize_t n = 0; n < size; n++) {
+		//a real UART drops what does not fit
+		if (m_rxBytes >= m_rxBuffer) {
+			m_overflows++;
+			continue;
+		}
+		
+		m_rx.push_back(buffer[n]);
+		m_rxBytes++;
+		
+		if (buffer[n] == '\n') {
+			m_arrivals.push_back(now);
+		}
+	}
+}
+
+void Emulator::Run()
+{
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+	
+	while (!quit) {
+		Clock::time_point now = Clock::now();
+		
+		//take next complete line from the receive buffer
+		if (!m_busy) {
+			auto nl = find(m_rx.begin(), m_rx.end(), '\n');
+			
+			//full buffer without a newline is garbage
+			if (nl == m_rx.end() and m_rxBytes >= m_rxBuffer) {
+				nl = m_rx.end() - 1;
+			}
+			
+			if (nl != m_rx.end()) {
+				//latency counts from the last byte, garbage has no arrival
+				m_received = now;
+				if (*nl == '\n') {
+					m_received = m_arrivals.front();
+					m_arrivals.pop_front();
+				}
+				
+				m_current.assign(m_rx.begin(), nl);
+				m_rxBytes -= (nl - m_rx.begin()) + 1;
+				m_rx.erase(m_rx.begin(), nl + 1);
+				
+				m_busy = true;
+				m_done = now + chrono::microseconds(m_delay);
+			}
+		}
+		
+		if (m_busy and now >= m_done) {
+			Process(m_current);
+			m_latency += chrono::duration<double>(Clock::now() - m_received).count();
+			m_busy = false;
+			continue;
+		}
+		
+		if (m_autoReport > 0 and now >= m_report + chrono::seconds(m_autoReport)) {
+			m_report = now;
+			Write(" " + Temperatures() + "\n");
+		}
+		
+		int timeout = 100;
+		if (m_busy) {
+			timeout = chrono::duration_cast<chrono::milliseconds>(m_done - now).count();
+		}
+		
+		pollfd fds;
+		fds.fd = m_fd;
+		fds.events = POLLIN;
+		
+		if (poll(&fds, 1, timeout) > 0) {
+			if (fds.revents & POLLIN) {
+				Receive();
+			}
+			else if (fds.revents & (POLLHUP | POLLERR)) {
+				//nobody has the terminal open yet, or host went away
+				usleep(10000);
+			}
+		}
+	}
+}
+
+void Emulator::Process(string_view line)
+{
+	while (line.size() > 0 and (line.back() == '\r' or line.back() == ' ')) {
+		line.remove_suffix(1);
+	}
+	
+	if (line.empty()) {
+		return;
+	}
+	
+	m_commands++;
+	
+	if (line[0] == 'N') {
+		size_t star = line.rfind('*');
+		int number = 0;
+		int checksum = -1;
+		
+		Number(line, 'N', number);
+		
+		if (star != string_view::npos) {
+			from_chars(line.data() + star + 1, line.data() + line.size(), checksum);
+		}
+		
+		uint8_t sum = 0;
+		for (size_t n = 0; n < star and n < line.size(); n++) {
+			sum ^= (uint8_t)line[n];
+		}
+		
+		bool corrupted = uniform_real_distribution<double>(0.0, 1.0)(m_random) < m_errorRate;
+		
+		if (star == string_view::npos or checksum != sum or corrupted) {
+			m_errors++;
+			Write("Error:checksum mismatch, Last Line: " + to_string(m_lastLine) + "\n");
+			Write("Resend: " + to_string(m_lastLine + 1) + "\nok\n");
+			return;
+		}
+		
+		size_t space = line.find(' ');
+		string_view code = line.substr(space + 1, star - space - 1);
+		
+		//M110 sets the line number itself
+		if (code.compare(0, 4, "M110") == 0) {
+			m_lastLine = number;
+		}
+		else if (number != m_lastLine + 1) {
+			m_errors++;
+			Write("Error:Line Number is not Last Line Number+1, Last Line: " + to_string(m_lastLine) + "\n");
+			Write("Resend: " + to_string(m_lastLine + 1) + "\nok\n");
+			return;
+		}
+		
+		m_lastLine = number;
+		Execute(code);
+	}
+	else {
+		Execute(line);
+	}
+}
+
+void Emulator::Execute(string_view code)
+{
+	int value;
+	
+	if (code.compare(0, 4, "M112") == 0) {
+		Write("Error:Printer halted. kill() called!\n");
+		return;
+	}
+	
+	if (code.compare(0, 4, "M105") == 0) {
+		Write("ok " + Temperatures() + "\n");
+		return;
+	}
+	
+	if (code.compare(0, 4, "M110") == 0) {
+		if (Number(code.substr(4), 'N', value)) {
+			m_lastLine = value;
+		}
+	}
+	
+	if (code.compare(0, 4, "M115") == 0) {
+		Write("FIRMWARE_NAME:Marlin Emulator PROTOCOL_VERSION:1.0 MACHINE_TYPE:PrintControl\n");
+		Write("Cap:AUTOREPORT_TEMP:1\n");
+		Write("Cap:EMERGENCY_PARSER:1\n");
+	}
+	
+	if (code.compare(0, 4, "M155") == 0) {
+		if (Number(code.substr(4), 'S', value)) {
+			m_autoReport = value;
+		}
+	}
+	
+	if (code.compare(0, 4, "M117") == 0) {
+		Write("echo:" + string(code.substr(4)) + "\n");
+	}
+	
+	Write("ok\n");
+}
+
+string Emulator::Temperatures()
+{
+	return "T:210.00 /210.00 B:60.00 /60.00 @:64 B@:12";
+}
+
+void Emulator::Report()
+{
+	double elapsed = chrono::duration<double>(Clock::now() - m_start).count();
+	
+	cout<<"commands:"<<m_commands<<endl;
+	cout<<"errors:"<<m_errors<<endl;
+	cout<<"overflows:"<<m_overflows<<endl;
+	cout<<"elapsed:"<<elapsed<<endl;
+	
+	if (elapsed > 0) {
+		cout<<"lines/s:"<<m_commands / elapsed<<endl;
+	}
+	
+	if (m_commands > 0) {
+		cout<<"latency us:"<<1000000.0 * m_latency / m_commands<<endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Emulator emulator;
+	const char* link = nullptr;
+	int opt;
+	
+	while ((opt = getopt(argc, argv, "d:r:e:l:h")) != -1) {
+		switch (opt) {
+			case 'd':
+				emulator.m_delay = atoi(optarg);
+			break;
+			
+			case 'r':
+				emulator.m_rxBuffer = atoi(optarg);
+			break;
+			
+			case 'e':
+				emulator.m_errorRate = atof(optarg);
+			break;
+			
+			case 'l':
+				link = optarg;
+			break;
+			
+			default:
+				cerr<<"usage: "<<argv[0]<<" [-d us per command] [-r rx buffer bytes] [-e error rate] [-l link path]"<<endl;
+				return 1;
+		}
+	}
+	
+	if (!emulator.Open(link)) {
+		return 1;
+	}
+	
+	emulator.Run();
+	emulator.Report();
+	
+	if (link) {
+		unlink(link);
+	}
+	
+	return 0;
+}
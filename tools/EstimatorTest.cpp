@@ -0,0 +1,134 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Print time of small files against trapezoids worked out by hand.
+	Junction deviation is off, so every block starts and ends at rest
+*/
+
+#include "GCode.hpp"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	const double Tolerance = 1e-4;
+	
+	int failures = 0;
+	
+	bool Near(double value, double expected)
+	{
+		return fabs(value - expected) <= Tolerance * max(1.0, expected);
+	}
+	
+	void Check(const char* name, const string& content, const MotionLimits& limits, double time, const vector<double>& layers)
+	{
+		const char* dir = getenv("TMPDIR");
+		string path = string(dir ? dir : "/tmp") + "/pc-estimator-" + to_string(getpid()) + ".gcode";
+		
+		FILE* file = fopen(path.c_str(), "w");
+		if (!file) {
+			cerr<<"FAIL "<<name<<": cannot write "<<path<<endl;
+			failures++;
+			return;
+		}
+		fputs(content.c_str(), file);
+		fclose(file);
+		
+		GCode gcode;
+		gcode.SetLimits(limits);
+		gcode.LoadFile(path.c_str());
+		unlink(path.c_str());
+		
+		bool ok = Near(gcode.PrintTime(), time);
+		if (!ok) {
+			cerr<<"FAIL "<<name<<": time "<<gcode.PrintTime()<<" s, expected "<<time<<endl;
+		}
+		
+		const vector<float>& times = gcode.LayerTimes();
+		
+		if (times.size() != layers.size()) {
+			cerr<<"FAIL "<<name<<": "<<times.size()<<" layers, expected "<<layers.size()<<endl;
+			ok = false;
+		}
+		
+		for (size_t n = 0; n < times.size() and n < layers.size(); n++) {
+			if (!Near(times[n], layers[n])) {
+				cerr<<"FAIL "<<name<<": layer "<<n<<" time "<<times[n]<<" s, expected "<<layers[n]<<endl;
+				ok = false;
+			}
+		}
+		
+		if (!ok) {
+			failures++;
+		}
+		
+		cout<<name<<" time="<<gcode.PrintTime()<<(ok ? " ok" : " failed")<<endl;
+	}
+}
+
+int main()
+{
+	clog.setstate(ios::failbit);
+	
+	MotionLimits limits;
+	limits.acceleration = 1000.0f;
+	limits.travelAcceleration = 1000.0f;
+	limits.retractAcceleration = 1000.0f;
+	limits.junctionDeviation = 0.0f;
+	
+	//50 mm/s reached after 0.05 s and 1.25 mm, cruise 97.5 mm in 1.95 s
+	Check("trapezoid", "G1 X100 E1 F3000\n", limits, 2.05, {2.05});
+	
+	//100 mm/s needs 10 mm, 2 mm only peaks at sqrt(1000 * 2) mm/s
+	double peak = sqrt(2000.0);
+	Check("triangle", "G1 X2 E0.1 F6000\n", limits, 2 * peak / 1000, {2 * peak / 1000});
+	
+	/*
+		2.05 s as above, then at 500 mm/s² 0.1 s each way and 95 mm in 1.9 s,
+		then X capped to 20 mm/s, 0.04 s each way and 99.2 mm in 4.96 s
+	*/
+	Check("limits", "G1 X100 E1 F3000\nM204 P500\nG1 X0 E2 F3000\nM203 X20\nG1 X100 E3 F3000\n", limits, 9.19, {9.19});
+	
+	/*
+		Z moves are capped to 5 mm/s and stay with the layer below:
+		0.01 + 0.175 / 5 s each. 10 mm at 10 mm/s take 0.02 + 9.9 / 10 s,
+		20 mm take 0.02 + 19.9 / 10 s
+	*/
+	Check("layers", "G1 Z0.2 F600\nG1 X10 E0.5 F600\nG1 Z0.4 F600\nG1 X30 E1 F600\n", limits, 3.11, {1.1, 2.01});
+	
+	Check("empty", "", limits, 0.0, {});
+	
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Loads small files with awkward line endings and checks the line
+	index GCode keeps over the mapping, then a file large enough to be
+	split between parser threads
+*/
+
+#include "GCode.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	int failures = 0;
+	
+	string TempPath()
+	{
+		const char* dir = getenv("TMPDIR");
+		return string(dir ? dir : "/tmp") + "/pc-line-index-" + to_string(getpid()) + ".gcode";
+	}
+	
+	void Check(const char* name, const string& content, const vector<string>& expected, int threads = 1)
+	{
+		string path = TempPath();
+		
+		FILE* file = fopen(path.c_str(), "wb");
+		if (!file) {
+			cerr<<"FAIL "<<name<<": cannot write "<<path<<endl;
+			failures++;
+			return;
+		}
+		fwrite(content.data(), 1, content.size(), file);
+		fclose(file);
+		
+		GCode gcode;
+		gcode.SetThreads(threads);
+		gcode.LoadFile(path.c_str());
+		
+		bool ok = (gcode.Lines() == (int)expected.size());
+		
+		for (int n = 0; ok and n < gcode.Lines(); n++) {
+			if (gcode.Line(n) != expected[n]) {
+				cerr<<"FAIL "<<name<<": line "<<n<<" is \""<<gcode.Line(n)<<"\", expected \""<<expected[n]<<"\""<<endl;
+				ok = false;
+			}
+		}
+		
+		if (gcode.Lines() != (int)expected.size()) {
+			cerr<<"FAIL "<<name<<": "<<gcode.Lines()<<" lines, expected "<<expected.size()<<endl;
+		}
+		
+		if (!ok) {
+			failures++;
+		}
+		
+		cout<<name<<" lines="<<gcode.Lines()<<(ok ? " ok" : " failed")<<endl;
+		unlink(path.c_str());
+	}
+}
+
+int main()
+{
+	clog.setstate(ios::failbit);
+	
+	Check("lf", "G28\nG1 X10\n", {"G28", "G1 X10"});
+	Check("crlf", "G28\r\nG1 X10\r\nM84\r\n", {"G28", "G1 X10", "M84"});
+	Check("unterminated", "G28\nG1 X10", {"G28", "G1 X10"});
+	Check("unterminated crlf", "G28\r\nG1 X10\r", {"G28", "G1 X10"});
+	Check("blank", "G28\n\n\nG1 X10\n", {"G28", "", "", "G1 X10"});
+	Check("blank crlf", "\r\nG28\r\n\r\n", {"", "G28", ""});
+	Check("only newline", "\n", {""});
+	Check("empty", "", {});
+	
+	//several chunks of at least 1 MB, lines cross every boundary
+	string content;
+	vector<string> expected;
+	for (int n = 0; content.size() < 5 * 1024 * 1024; n++) {
+		string line = "G1 X" + to_string(n % 200) + " Y" + to_string(n % 150) + " E" + to_string(n);
+		
+		if (n % 7 == 0) {
+			line.clear();
+		}
+		
+		content += line + ((n % 3 == 0) ? "\r\n" : "\n");
+		expected.push_back(line);
+	}
+	content += "M84";
+	expected.push_back("M84");
+	
+	Check("threads", content, expected, 4);
+	
+	return (failures == 0) ? 0 : 1;
+}
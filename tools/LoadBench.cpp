@@ -0,0 +1,217 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Loads the same file with 1, 2, 4, 8 and 16 parser threads, reports
+	the best load time of each and fails when any of them disagrees with
+	the single threaded statistics. Generates a large file when not given one
+*/
+
+#include "GCode.hpp"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace pc;
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	const int Passes = 3;
+	
+	class Stats
+	{
+		public:
+		
+		int lines;
+		int layers;
+		float height;
+		float filament;
+		double time;
+		size_t segments;
+		
+		//folds every segment and layer time, order sensitive
+		double check;
+		
+		bool operator == (const Stats& other) const
+		{
+			return lines == other.lines and layers == other.layers and height == other.height
+				and filament == other.filament and time == other.time
+				and segments == other.segments and check == other.check;
+		}
+	};
+	
+	Stats Collect(GCode& gcode)
+	{
+		Stats stats;
+		stats.lines = gcode.Lines();
+		stats.layers = gcode.Layers();
+		stats.height = gcode.Height();
+		stats.filament = gcode.Filament();
+		stats.time = gcode.PrintTime();
+		
+		GRender* render = gcode.Render();
+		stats.segments = render->Segments();
+		stats.check = 0.0;
+		
+		for (size_t n = 0; n < render->Segments(); n++) {
+			Point start = render->Start(n);
+			Point end = render->End(n);
+			stats.check = stats.check * 0.5 + start.x + 2 * start.y + 3 * end.x + 4 * end.y
+				+ render->Line(n) + (int)render->Type(n);
+		}
+		
+		for (float time : gcode.LayerTimes()) {
+			stats.check = stats.check * 0.5 + time;
+		}
+		
+		return stats;
+	}
+	
+	//same layout as ParseBench, written out so it can be mapped
+	bool Generate(const string& path, int count)
+	{
+		FILE* file = fopen(path.c_str(), "w");
+		if (!file) {
+			return false;
+		}
+		
+		float e = 0.0f;
+		
+		for (int n = 0; n < count; n++) {
+			if (n % 2000 == 0) {
+				fprintf(file, ";LAYER_CHANGE\nG1 Z%.3f F9000\n;TYPE:External perimeter\n", 0.2f + n / 2000 * 0.2f);
+			}
+			
+			switch (n % 40) {
+				case 0:
+					fprintf(file, "G1 E-0.8 F2100\n");
+				break;
+				
+				case 1:
+					fprintf(file, "G0 X%.3f Y%.3f F9000\n", 50.0f + n % 97, 60.0f + n % 89);
+				break;
+				
+				case 2:
+					fprintf(file, "G1 E0.8 F2100\n");
+				break;
+				
+				default:
+					e += 0.0315f;
+					fprintf(file, "G1 X%.3f Y%.3f E%.5f\n", 50.0f + (n * 7) % 101 * 0.5f, 60.0f + (n * 13) % 103 * 0.5f, e);
+			}
+		}
+		
+		fclose(file);
+		return true;
+	}
+	
+	double Seconds(Clock::time_point start)
+	{
+		return chrono::duration<double>(Clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	string path;
+	bool generated = (argc < 2);
+	
+	if (generated) {
+		const char* dir = getenv("TMPDIR");
+		path = string(dir ? dir : "/tmp") + "/pc-load-bench-" + to_string(getpid()) + ".gcode";
+		
+		if (!Generate(path, 2000000)) {
+			cerr<<"Failed to write "<<path<<endl;
+			return 1;
+		}
+	}
+	else {
+		path = argv[1];
+	}
+	
+	clog.setstate(ios::failbit);
+	
+	const int threads[] = {1, 2, 4, 8, 16};
+	
+	Stats reference = {};
+	double base = 0.0;
+	bool ok = true;
+	
+	for (int count : threads) {
+		double best = 1e9;
+		Stats stats;
+		
+		for (int pass = 0; pass < Passes; pass++) {
+			GCode gcode;
+			gcode.SetThreads(count);
+			
+			Clock::time_point start = Clock::now();
+			gcode.LoadFile(path.c_str());
+			best = min(best, Seconds(start));
+			
+			stats = Collect(gcode);
+		}
+		
+		if (count == 1) {
+			reference = stats;
+			base = best;
+		}
+		
+		bool same = (stats == reference);
+		ok = ok and same;
+		
+		cout<<"threads="<<count
+			<<" load s="<<best
+			<<" speedup="<<base / best
+			<<" lines="<<stats.lines
+			<<" layers="<<stats.layers
+			<<" segments="<<stats.segments
+			<<" filament="<<stats.filament
+			<<" time s="<<stats.time
+			<<(same ? " same" : " DIFFERENT")<<endl;
+	}
+	
+	cout<<"cores="<<thread::hardware_concurrency()<<endl;
+	
+	if (generated) {
+		unlink(path.c_str());
+	}
+	
+	if (!ok) {
+		cerr<<"FAIL statistics depend on the thread count"<<endl;
+		return 1;
+	}
+	
+	return 0;
+}
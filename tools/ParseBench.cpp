@@ -0,0 +1,212 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Tokenizer lines per second, the allocating Tokens()/Value() pair the
+	parser used to have against ScanWords. Reads a file when given one,
+	otherwise generates slicer like output
+*/
+
+#include "GCode.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	const int Passes = 5;
+	
+	//former tokenizer, kept as the reference
+	vector<string> Tokens(string& line)
+	{
+		vector<string> tokens;
+		bool knee = false;
+		string tmp;
+		
+		for (char c : line) {
+			if (c == ' ') {
+				if (knee) {
+					tokens.push_back(tmp);
+					tmp.clear();
+					knee = false;
+				}
+			}
+			else {
+				if (c == ';') {
+					break;
+				}
+				knee = true;
+				tmp.push_back(c);
+			}
+		}
+		
+		if (knee) {
+			tokens.push_back(tmp);
+		}
+		
+		return tokens;
+	}
+	
+	bool Value(string& token, char& name, float& value)
+	{
+		if (token.size() < 2) {
+			return false;
+		}
+		
+		name = token[0];
+		
+		if (name < 'A' or name > 'Z') {
+			return false;
+		}
+		
+		try {
+			value = stof(token.substr(1));
+		}
+		catch (exception& e) {
+			return false;
+		}
+		
+		return true;
+	}
+	
+	//perimeters, infill, travels, retractions and layer comments
+	vector<string> Generate(int count)
+	{
+		vector<string> lines;
+		char text[128];
+		float e = 0.0f;
+		
+		for (int n = 0; n < count; n++) {
+			if (n % 2000 == 0) {
+				lines.push_back(";LAYER_CHANGE");
+				snprintf(text, sizeof(text), "G1 Z%.3f F9000", 0.2f + n / 2000 * 0.2f);
+				lines.push_back(text);
+				lines.push_back(";TYPE:External perimeter");
+			}
+			
+			switch (n % 40) {
+				case 0:
+					lines.push_back("G1 E-0.8 F2100");
+				break;
+				
+				case 1:
+					snprintf(text, sizeof(text), "G0 X%.3f Y%.3f F9000", 50.0f + n % 97, 60.0f + n % 89);
+					lines.push_back(text);
+				break;
+				
+				case 2:
+					lines.push_back("G1 E0.8 F2100");
+				break;
+				
+				default:
+					e += 0.0315f;
+					snprintf(text, sizeof(text), "G1 X%.3f Y%.3f E%.5f", 50.0f + (n * 7) % 101 * 0.5f, 60.0f + (n * 13) % 103 * 0.5f, e);
+					lines.push_back(text);
+			}
+		}
+		
+		return lines;
+	}
+	
+	double Seconds(Clock::time_point start)
+	{
+		return chrono::duration<double>(Clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	vector<string> lines;
+	
+	if (argc > 1) {
+		ifstream file(argv[1]);
+		if (!file) {
+			cerr<<"Failed to open "<<argv[1]<<endl;
+			return 1;
+		}
+		
+		string line;
+		while (getline(file, line)) {
+			lines.push_back(line);
+		}
+	}
+	else {
+		lines = Generate(1000000);
+	}
+	
+	//sums keep the work from being optimized away and must agree
+	double before = 0.0;
+	Clock::time_point start = Clock::now();
+	
+	for (int pass = 0; pass < Passes; pass++) {
+		for (string& line : lines) {
+			vector<string> tokens = Tokens(line);
+			
+			for (string& token : tokens) {
+				char name;
+				float value;
+				if (Value(token, name, value)) {
+					before += value;
+				}
+			}
+		}
+	}
+	
+	double beforeTime = Seconds(start);
+	
+	double after = 0.0;
+	Word words[16];
+	start = Clock::now();
+	
+	for (int pass = 0; pass < Passes; pass++) {
+		for (string& line : lines) {
+			int count = ScanWords(line, words, 16);
+			
+			for (int n = 0; n < count; n++) {
+				after += words[n].value;
+			}
+		}
+	}
+	
+	double afterTime = Seconds(start);
+	double total = (double)lines.size() * Passes;
+	
+	cout<<"lines="<<lines.size()
+		<<" before lines_per_s="<<total / beforeTime
+		<<" after lines_per_s="<<total / afterTime
+		<<" speedup="<<beforeTime / afterTime
+		<<" sums="<<before<<"/"<<after<<endl;
+	
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Loads a file and reports how many primitives the preview would emit
+	per layer, at several zoom levels, with and without the render index.
+	Then scrolls through layers like the mouse wheel does and reports
+	frame times with and without the raster cache
+*/
+
+#include "GCode.hpp"
+#include "RasterCache.hpp"
+#include "RenderIndex.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	double Elapsed(Clock::time_point start)
+	{
+		return chrono::duration<double, milli>(Clock::now() - start).count();
+	}
+	
+	//view size in pixels and wheel tick period
+	const int ViewWidth = 800;
+	const int ViewHeight = 600;
+	const float ViewScale = 2.0f;
+	const int TickMs = 30;
+	
+	/*
+		Wheel ticks from the middle layer up, then back down, copying every
+		frame into a buffer the way GView copies it into its bitmap
+	*/
+	void Scroll(const char* name, GRender* render, size_t budget)
+	{
+		RasterCache cache;
+		cache.SetBudget(budget);
+		cache.SetView(ViewScale, ViewWidth, ViewHeight);
+		cache.SetRender(render);
+		
+		int first = render->Layers() / 2;
+		int count = min(100, render->Layers() - first);
+		
+		vector<int> layers;
+		for (int n = 0; n < count; n++) {
+			layers.push_back(first + n);
+		}
+		for (int n = count - 1; n >= 0; n--) {
+			layers.push_back(first + n);
+		}
+		
+		vector<uint32_t> frame(ViewWidth * ViewHeight);
+		vector<double> times;
+		
+		for (int layer : layers) {
+			Clock::time_point start = Clock::now();
+			shared_ptr<const Raster> raster = cache.Get(layer);
+			memcpy(frame.data(), raster->Bits(), raster->Bytes());
+			double ms = Elapsed(start);
+			times.push_back(ms);
+			
+			this_thread::sleep_for(chrono::milliseconds(TickMs) - chrono::duration<double, milli>(ms));
+		}
+		
+		sort(times.begin(), times.end());
+		
+		cout<<name
+			<<" frames="<<times.size()
+			<<" p50 ms="<<times[times.size() / 2]
+			<<" p95 ms="<<times[times.size() * 95 / 100]
+			<<" max ms="<<times.back()
+			<<" hits="<<cache.Hits()
+			<<" misses="<<cache.Misses()
+			<<" prefetched="<<cache.Prefetched()
+			<<" cached MB="<<cache.Bytes() / (1024 * 1024)<<endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		cerr<<"usage: "<<argv[0]<<" file [view size mm]"<<endl;
+		return 1;
+	}
+	
+	float size = (argc > 2) ? atof(argv[2]) : 0.0f;
+	
+	clog.setstate(ios::failbit);
+	
+	GCode gcode;
+	Clock::time_point start = Clock::now();
+	gcode.LoadFile(argv[1]);
+	cout<<"load ms="<<Elapsed(start)<<" layers="<<gcode.Layers()<<endl;
+	
+	GRender* render = gcode.Render();
+	if (render->Layers() == 0) {
+		return 0;
+	}
+	
+	RenderIndex index;
+	index.SetRender(render);
+	
+	start = Clock::now();
+	index.Build();
+	cout<<"index ms="<<Elapsed(start)<<endl;
+	
+	//whole plate, or a window around the middle layer center
+	Bounds view(-1e6f, -1e6f, 1e6f, 1e6f);
+	if (size > 0.0f) {
+		Bounds plate = index.Layer(render->Layers() / 2).bounds;
+		float x = 0.5f * (plate.left + plate.right);
+		float y = 0.5f * (plate.top + plate.bottom);
+		view = Bounds(x - size / 2, y - size / 2, x + size / 2, y + size / 2);
+	}
+	
+	const float pixels[] = {0.01f, 0.1f, 0.5f, 2.0f, 8.0f, 32.0f};
+	
+	for (float pixel : pixels) {
+		size_t emitted = 0;
+		float check = 0.0f;
+		
+		start = Clock::now();
+		for (int n = 0; n < render->Layers(); n++) {
+			emitted += index.Visit(n, view, pixel, [&check](Point a, Point b, SegmentType type) {
+				check += a.x - b.y + (type == SegmentType::Fill);
+			});
+		}
+		double ms = Elapsed(start);
+		
+		cout<<"pixel mm="<<pixel
+			<<" segments="<<render->Segments()
+			<<" emitted="<<emitted
+			<<" ratio="<<(double)emitted / render->Segments()
+			<<" visit ms="<<ms
+			<<" check="<<check<<endl;
+	}
+	
+	Scroll("uncached", render, 0);
+	Scroll("cached", render, 64 * 1024 * 1024);
+	
+	return 0;
+}
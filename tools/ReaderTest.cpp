@@ -0,0 +1,238 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Firmware output through a pseudo terminal into the reader loop the
+	serial driver uses: bulk reads into a LineBuffer, lines split in
+	place and parsed. Fails unless every byte and line comes out as it
+	went in, then times the former one byte per read loop for reference
+*/
+
+#include "LineBuffer.hpp"
+#include "Response.hpp"
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace pc;
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	const int Lines = 300000;
+	
+	//what a busy Marlin sends, now and then a line longer than the buffer
+	string Generate(int& lines)
+	{
+		const char* samples[] = {
+			"ok\n",
+			"ok T:210.00 /210.00 B:60.00 /60.00 @:64 B@:12\n",
+			" T:209.87 /210.00 B:60.02 /60.00 @:66 B@:10\n",
+			"echo:busy: processing\n",
+			"Resend: 1234\n",
+			"echo:Unknown command: \"M999\"\n"
+		};
+		
+		mt19937 random(1);
+		string stream;
+		lines = 0;
+		
+		for (int n = 0; n < Lines; n++) {
+			if (n % 50000 == 49999) {
+				stream += "echo:" + string(LineBuffer::Capacity + random() % 3000, 'x') + "\n";
+			}
+			else {
+				stream += samples[random() % 6];
+			}
+			lines++;
+		}
+		
+		return stream;
+	}
+	
+	/*
+		Pseudo terminal in raw mode, the test reads the device side
+	*/
+	class Pty
+	{
+		public:
+		
+		Pty() : master(-1), device(-1)
+		{
+			master = posix_openpt(O_RDWR | O_NOCTTY);
+			if (master < 0 or grantpt(master) < 0 or unlockpt(master) < 0) {
+				return;
+			}
+			
+			device = open(ptsname(master), O_RDWR | O_NOCTTY);
+			if (device < 0) {
+				return;
+			}
+			
+			termios attributes;
+			tcgetattr(device, &attributes);
+			cfmakeraw(&attributes);
+			tcsetattr(device, TCSANOW, &attributes);
+		}
+		
+		~Pty()
+		{
+			if (device >= 0) {
+				close(device);
+			}
+			if (master >= 0) {
+				close(master);
+			}
+		}
+		
+		// firmware side, from another thread
+		void Write(string_view data)
+		{
+			while (data.size() > 0) {
+				ssize_t size = write(master, data.data(), data.size());
+				if (size <= 0) {
+					return;
+				}
+				data.remove_prefix(size);
+			}
+		}
+		
+		int master;
+		int device;
+	};
+	
+	//whole process, the writer thread included
+	double CpuSeconds()
+	{
+		return (double)clock() / CLOCKS_PER_SEC;
+	}
+}
+
+int main()
+{
+	int lines;
+	string stream = Generate(lines);
+	
+	string received;
+	received.reserve(stream.size());
+	int count = 0;
+	int parsed = 0;
+	
+	{
+		Pty pty;
+		if (pty.device < 0) {
+			cerr<<"Failed to open a pseudo terminal"<<endl;
+			return 1;
+		}
+		
+		thread firmware([&]() { pty.Write(stream); });
+		
+		LineBuffer input;
+		string_view line;
+		Response response;
+		
+		Clock::time_point start = Clock::now();
+		double cpu = CpuSeconds();
+		
+		while (received.size() < stream.size()) {
+			pollfd fds = {pty.device, POLLIN, 0};
+			if (poll(&fds, 1, 2000) <= 0) {
+				break;
+			}
+			
+			ssize_t size = read(pty.device, input.Space(), input.Free());
+			if (size <= 0) {
+				break;
+			}
+			
+			input.Commit(size);
+			
+			while (input.Next(line)) {
+				ParseResponse(line, response);
+				parsed += (response.type != ResponseType::Unknown) ? 1 : 0;
+				
+				received.append(line);
+				count += (line.back() == '\n') ? 1 : 0;
+			}
+		}
+		
+		double elapsed = chrono::duration<double>(Clock::now() - start).count();
+		cpu = CpuSeconds() - cpu;
+		firmware.join();
+		
+		cout<<"bulk lines="<<count<<" parsed="<<parsed<<" lines_per_s="<<count / elapsed
+			<<" MB_per_s="<<received.size() / elapsed / 1e6<<" cpu_s="<<cpu<<endl;
+	}
+	
+	if (received != stream or count != lines) {
+		cerr<<"FAIL received "<<received.size()<<" of "<<stream.size()<<" bytes, "
+			<<count<<" of "<<lines<<" lines"<<endl;
+		return 1;
+	}
+	
+	//reference, one read per byte appended to a string
+	{
+		Pty pty;
+		thread firmware([&]() { pty.Write(stream); });
+		
+		string line;
+		size_t bytes = 0;
+		int byteLines = 0;
+		char c;
+		
+		Clock::time_point start = Clock::now();
+		double cpu = CpuSeconds();
+		
+		while (bytes < stream.size() and read(pty.device, &c, 1) == 1) {
+			bytes++;
+			line += c;
+			if (c == '\n') {
+				byteLines++;
+				line.clear();
+			}
+		}
+		
+		double elapsed = chrono::duration<double>(Clock::now() - start).count();
+		cpu = CpuSeconds() - cpu;
+		firmware.join();
+		
+		cout<<"byte lines="<<byteLines<<" lines_per_s="<<byteLines / elapsed
+			<<" MB_per_s="<<bytes / elapsed / 1e6<<" cpu_s="<<cpu<<endl;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,123 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	ParseResponse lines per second over firmware transcripts, one result
+	per file. Lines are parsed from a single buffer, as the reader thread
+	gets them from LineBuffer
+*/
+
+#include "Response.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	//lines parsed per file, whatever its length
+	const long Target = 20000000;
+	
+	double Seconds(Clock::time_point start)
+	{
+		return chrono::duration<double>(Clock::now() - start).count();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		cerr<<"usage: "<<argv[0]<<" transcript..."<<endl;
+		return 1;
+	}
+	
+	for (int n = 1; n < argc; n++) {
+		ifstream file(argv[n]);
+		if (!file) {
+			cerr<<"Failed to open "<<argv[n]<<endl;
+			return 1;
+		}
+		
+		stringstream stream;
+		stream<<file.rdbuf();
+		string text = stream.str();
+		
+		//views keep their line end, as LineBuffer hands them out
+		vector<string_view> lines;
+		size_t start = 0;
+		
+		while (start < text.size()) {
+			size_t end = text.find('\n', start);
+			end = (end == string::npos) ? text.size() : end + 1;
+			lines.push_back(string_view(text).substr(start, end - start));
+			start = end;
+		}
+		
+		if (lines.empty()) {
+			continue;
+		}
+		
+		long passes = Target / lines.size() + 1;
+		
+		//counts keep the work from being optimized away
+		long oks = 0;
+		long temperatures = 0;
+		long messages = 0;
+		Response response;
+		
+		Clock::time_point begin = Clock::now();
+		
+		for (long pass = 0; pass < passes; pass++) {
+			for (string_view line : lines) {
+				ParseResponse(line, response);
+				oks += response.ok;
+				temperatures += (response.type == ResponseType::Temperature);
+				messages += (response.text.size() > 0);
+			}
+		}
+		
+		double elapsed = Seconds(begin);
+		double total = (double)lines.size() * passes;
+		
+		cout<<argv[n]
+			<<" lines="<<lines.size()
+			<<" lines_per_s="<<total / elapsed
+			<<" ns_per_line="<<1e9 * elapsed / total
+			<<" ok="<<oks / passes
+			<<" temperature="<<temperatures / passes
+			<<" messages="<<messages / passes<<endl;
+	}
+	
+	return 0;
+}
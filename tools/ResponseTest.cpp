@@ -0,0 +1,209 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	ParseResponse against known lines, then against every truncation of
+	the given transcripts and random or mutated lines. Each case is copied
+	into a buffer of its exact size, so reading past it shows up under
+	the address sanitizer
+*/
+
+#include "Response.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace pc;
+
+using namespace std;
+
+namespace
+{
+	const int RandomCases = 200000;
+	const int MutatedCases = 200000;
+	
+	int failures = 0;
+	
+	void Fail(string_view in, const char* why)
+	{
+		//first ones are enough to see what is wrong
+		if (failures++ < 20) {
+			cerr<<"FAIL "<<why<<": \""<<in<<"\""<<endl;
+		}
+	}
+	
+	bool Same(const Response& a, const Response& b)
+	{
+		return a.type == b.type and a.ok == b.ok and a.resend == b.resend
+			and a.text.data() == b.text.data() and a.text.size() == b.text.size()
+			and a.fields == b.fields;
+	}
+	
+	void Check(const string& line)
+	{
+		unique_ptr<char[]> buffer(new char[line.size()]);
+		line.copy(buffer.get(), line.size());
+		string_view in(buffer.get(), line.size());
+		
+		Response response;
+		ParseResponse(in, response);
+		
+		if (response.text.size() > 0 and (response.text.data() < in.data()
+			or response.text.data() + response.text.size() > in.data() + in.size())) {
+			Fail(line, "text outside the line");
+		}
+		
+		if ((response.type == ResponseType::Resend) != (response.resend >= 0)) {
+			Fail(line, "resend without type");
+		}
+		
+		if (response.ok and response.type != ResponseType::Ok and response.type != ResponseType::Temperature) {
+			Fail(line, "ok on a message");
+		}
+		
+		if ((response.type == ResponseType::Temperature) != (response.fields != 0)) {
+			Fail(line, "temperature without fields");
+		}
+		
+		if (response.fields >= 2 * FieldWait) {
+			Fail(line, "unknown field");
+		}
+		
+		//whatever was parsed before must not leak into the next one
+		Response again;
+		again.type = ResponseType::Busy;
+		again.ok = true;
+		again.resend = 7;
+		again.fields = FieldBed;
+		ParseResponse(in, again);
+		
+		if (!Same(response, again)) {
+			Fail(line, "depends on the previous response");
+		}
+	}
+	
+	void Expect(string_view line, ResponseType type, bool ok, int resend, uint32_t fields)
+	{
+		Response response;
+		ParseResponse(line, response);
+		
+		if (response.type != type or response.ok != ok or response.resend != resend or response.fields != fields) {
+			Fail(line, "unexpected parse");
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Expect("ok\n", ResponseType::Ok, true, -1, 0);
+	Expect("ok T:24.53 /0.00 B:23.98 /0.00 @:0 B@:0\n", ResponseType::Temperature, true, -1, 63);
+	Expect(" T:201.44 E:0 W:3\n", ResponseType::Temperature, false, -1, FieldHotend | FieldWait);
+	Expect("ok B:60.0 /60.0 T0:209.8 /210.0\r\n", ResponseType::Temperature, true, -1, 15);
+	Expect("Resend: 1185\n", ResponseType::Resend, false, 1185, 0);
+	Expect("rs 1250\n", ResponseType::Resend, false, 1250, 0);
+	Expect("Resend: x\n", ResponseType::Unknown, false, -1, 0);
+	Expect("echo:busy: processing\n", ResponseType::Busy, false, -1, 0);
+	Expect("!! Timer too close\n", ResponseType::Error, false, -1, 0);
+	Expect("Cap:AUTOREPORT_TEMP:1\n", ResponseType::Capability, false, -1, 0);
+	Expect("okay\n", ResponseType::Unknown, false, -1, 0);
+	Expect("", ResponseType::Unknown, false, -1, 0);
+	
+	vector<string> lines;
+	
+	for (int n = 1; n < argc; n++) {
+		ifstream file(argv[n]);
+		if (!file) {
+			cerr<<"Failed to open "<<argv[n]<<endl;
+			return 1;
+		}
+		
+		string line;
+		while (getline(file, line)) {
+			lines.push_back(line + "\n");
+		}
+	}
+	
+	long cases = 0;
+	
+	for (const string& line : lines) {
+		for (size_t size = 0; size <= line.size(); size++) {
+			Check(line.substr(0, size));
+			cases++;
+		}
+	}
+	
+	//protocol characters mostly, so prefixes and numbers come up often
+	const string alphabet = "okOKTBEW@:/ .-+0123456789eEnN?!rsRsendecho:busyError:Cap\r\n\t";
+	mt19937 random(1);
+	
+	for (int n = 0; n < RandomCases; n++) {
+		string line(random() % 48, ' ');
+		
+		for (char& c : line) {
+			c = (random() % 8 == 0) ? (char)(random() % 256) : alphabet[random() % alphabet.size()];
+		}
+		
+		Check(line);
+		cases++;
+	}
+	
+	for (int n = 0; n < MutatedCases and lines.size() > 0; n++) {
+		string line = lines[random() % lines.size()];
+		int edits = 1 + random() % 4;
+		
+		for (int edit = 0; edit < edits; edit++) {
+			size_t at = random() % (line.size() + 1);
+			char c = (random() % 4 == 0) ? (char)(random() % 256) : alphabet[random() % alphabet.size()];
+			
+			switch (random() % 3) {
+				case 0:
+					line.insert(at, 1, c);
+				break;
+				
+				case 1:
+					if (at < line.size()) {
+						line.erase(at, 1);
+					}
+				break;
+				
+				default:
+					if (at < line.size()) {
+						line[at] = c;
+					}
+			}
+		}
+		
+		Check(line);
+		cases++;
+	}
+	
+	cout<<"cases="<<cases<<" failures="<<failures<<endl;
+	
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,58 @@
+#!/bin/sh
+#
+# Streams a generated job into PrintEmulator once per send mode and prints
+# the streamer throughput and send to ok latency (latency_us), with the
+# time each command spent in the emulator from its last byte to its ok
+# (command_latency_us). Run by meson benchmark.
+#
+# usage: StreamBench.sh emulator streamer [lines] [us per command]
+
+emulator=$1
+streamer=$2
+lines=${3:-20000}
+delay=${4:-200}
+
+if [ ! -x "$emulator" ] || [ ! -x "$streamer" ]; then
+	echo "usage: $0 emulator streamer [lines] [us per command]" >&2
+	exit 1
+fi
+
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+# perimeter like moves with a layer change every 500 lines
+awk -v n="$lines" 'BEGIN {
+	print "G28"
+	for (i = 0; i < n; i++) {
+		if (i % 500 == 0) {
+			printf "G1 Z%.2f F600\n", 0.2 + i / 500 * 0.2
+		}
+		printf "G1 X%.3f Y%.3f E%.5f F1800\n", 100 + 50 * sin(i / 50), 100 + 50 * cos(i / 50), i * 0.03
+	}
+}' > "$dir/job.gcode"
+
+# name, firmware rx buffer bytes, streamer options
+run() {
+	name=$1
+	rx=$2
+	shift 2
+	
+	"$emulator" -d "$delay" -r "$rx" -l "$dir/tty" > "$dir/emulator.txt" &
+	pid=$!
+	
+	while [ ! -e "$dir/tty" ]; do
+		sleep 0.1
+	done
+	
+	result=$("$streamer" -d 100 -i 100000 "$@" "$dir/tty" "$dir/job.gcode" | grep '^done')
+	kill "$pid"
+	wait "$pid"
+	
+	latency=$(grep '^latency us:' "$dir/emulator.txt" | cut -d: -f2)
+	echo "$name $result command_latency_us=$latency"
+}
+
+run pingpong 127 -m p
+run window-4 127 -m w -w 4 -r 127
+run window-8 127 -m w -w 8 -r 127
+run window-16 1024 -m w -w 16 -r 1024
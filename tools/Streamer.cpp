@@ -0,0 +1,514 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2026 Enrique Medina Gremaldos <quique@necos.es>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/*
+	Streams a job to a printer from the command line, using the same
+	protocol code as the GUI. Progress goes to stdout as key=value lines.
+*/
+
+#include "Protocol.hpp"
+#include "LineBuffer.hpp"
+#include "Logger.hpp"
+#include "Response.hpp"
+
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <getopt.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace pc;
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+namespace
+{
+	volatile sig_atomic_t quit = 0;
+	
+	void OnSignal(int)
+	{
+		quit = 1;
+	}
+	
+	//reader and main thread lines must not interleave
+	mutex outputMutex;
+	
+	void Print(const string& line)
+	{
+		lock_guard<mutex> lock(outputMutex);
+		cout<<line<<endl;
+	}
+	
+	struct Rate
+	{
+		int baud;
+		speed_t speed;
+	};
+	
+	const Rate Rates[] = {
+		{9600, B9600},
+		{19200, B19200},
+		{38400, B38400},
+		{57600, B57600},
+		{115200, B115200},
+		{230400, B230400},
+#ifdef B460800
+		{460800, B460800},
+#endif
+#ifdef B921600
+		{921600, B921600},
+#endif
+	};
+	
+	const char* StatusName(StepResult result)
+	{
+		switch (result) {
+			case StepResult::Continue:
+				return "interrupted";
+			case StepResult::Ended:
+				return "ended";
+			case StepResult::NoResponse:
+				return "no-response";
+			case StepResult::Lost:
+				return "lost";
+			case StepResult::Halted:
+				return "halted";
+		}
+		
+		return "unknown";
+	}
+}
+
+/*
+	Printer on a terminal device, configured through termios
+*/
+class TtyPrinter : public Protocol
+{
+	public:
+	
+	TtyPrinter() :
+	m_baud(115200),
+	m_parity('n'),
+	m_stopBits(1),
+	m_dataBits(8),
+	m_flow('n'),
+	m_fd(-1),
+	m_connected(false),
+	m_acked(0),
+	m_latency(0.0)
+	{
+	}
+	
+	~TtyPrinter()
+	{
+		Disconnect();
+	}
+	
+	bool Connect(const char* path);
+	void Disconnect();
+	
+	// mean time from writing a line to reading its ok, in microseconds
+	double Latency();
+	
+	int m_baud;
+	char m_parity;
+	int m_stopBits;
+	int m_dataBits;
+	char m_flow;
+	
+	protected:
+	
+	void Send(string_view data) override;
+	void Reader();
+	
+	int m_fd;
+	atomic<bool> m_connected;
+	thread m_reader;
+	
+	//firmware answers every line with one ok, in order
+	mutex m_latencyMutex;
+	deque<Clock::time_point> m_sent;
+	long m_acked;
+	double m_latency;
+};
+
+bool TtyPrinter::Connect(const char* path)
+{
+	speed_t speed = 0;
+	
+	for (const Rate& rate : Rates) {
+		if (rate.baud == m_baud) {
+			speed = rate.speed;
+		}
+	}
+	
+	if (speed == 0) {
+		cerr<<"Unsupported baud rate "<<m_baud<<endl;
+		return false;
+	}
+	
+	m_fd = open(path, O_RDWR | O_NOCTTY);
+	if (m_fd < 0) {
+		cerr<<"Failed to open "<<path<<": "<<strerror(errno)<<endl;
+		return false;
+	}
+	
+	termios tio;
+	if (tcgetattr(m_fd, &tio) < 0) {
+		cerr<<"Not a terminal: "<<path<<endl;
+		Disconnect();
+		return false;
+	}
+	
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	
+	tio.c_cflag |= CLOCAL | CREAD;
+	
+	tio.c_cflag &= ~CSIZE;
+	tio.c_cflag |= (m_dataBits == 7) ? CS7 : CS8;
+	
+	tio.c_cflag &= ~(PARENB | PARODD);
+	if (m_parity == 'e') {
+		tio.c_cflag |= PARENB;
+	}
+	else if (m_parity == 'o') {
+		tio.c_cflag |= PARENB | PARODD;
+	}
+	
+	if (m_stopBits == 2) {
+		tio.c_cflag |= CSTOPB;
+	}
+	else {
+		tio.c_cflag &= ~CSTOPB;
+	}
+	
+	tio.c_cflag &= ~CRTSCTS;
+	tio.c_iflag &= ~(IXON | IXOFF);
+	if (m_flow == 'h') {
+		tio.c_cflag |= CRTSCTS;
+	}
+	else if (m_flow == 's') {
+		tio.c_iflag |= IXON | IXOFF;
+	}
+	
+	tio.c_cc[VMIN] = 1;
+	tio.c_cc[VTIME] = 0;
+	
+	if (tcsetattr(m_fd, TCSANOW, &tio) < 0) {
+		cerr<<"Failed to configure "<<path<<": "<<strerror(errno)<<endl;
+		Disconnect();
+		return false;
+	}
+	
+	m_connected = true;
+	m_reader = thread(&TtyPrinter::Reader, this);
+	
+	return true;
+}
+
+void TtyPrinter::Disconnect()
+{
+	m_connected = false;
+	
+	if (m_reader.joinable()) {
+		m_reader.join();
+	}
+	
+	if (m_fd >= 0) {
+		close(m_fd);
+		m_fd = -1;
+	}
+}
+
+double TtyPrinter::Latency()
+{
+	lock_guard<mutex> lock(m_latencyMutex);
+	return (m_acked > 0) ? 1000000.0 * m_latency / m_acked : 0.0;
+}
+
+void TtyPrinter::Send(string_view data)
+{
+	{
+		lock_guard<mutex> lock(m_latencyMutex);
+		m_sent.insert(m_sent.end(), count(data.begin(), data.end(), '\n'), Clock::now());
+	}
+	
+	while (data.size() > 0) {
+		ssize_t size = write(m_fd, data.data(), data.size());
+		if (size <= 0) {
+			cerr<<"Output error:"<<size<<endl;
+			return;
+		}
+		data.remove_prefix(size);
+	}
+}
+
+void TtyPrinter::Reader()
+{
+	LineBuffer input;
+	string_view line;
+	Response response;
+	
+	while (m_connected) {
+		pollfd fds = {m_fd, POLLIN, 0};
+		
+		//wake up now and then to notice disconnection
+		if (poll(&fds, 1, 250) <= 0) {
+			continue;
+		}
+		
+		ssize_t size = read(m_fd, input.Space(), input.Free());
+		if (size <= 0) {
+			break;
+		}
+		
+		input.Commit(size);
+		
+		while (input.Next(line)) {
+			PC_LOG(LogLevel::Trace)<<"<<"<<line;
+			Receive(line, response);
+			
+			if (response.ok) {
+				lock_guard<mutex> lock(m_latencyMutex);
+				
+				if (!m_sent.empty()) {
+					m_latency += chrono::duration<double>(Clock::now() - m_sent.front()).count();
+					m_sent.pop_front();
+					m_acked++;
+				}
+			}
+			
+			if (response.type == ResponseType::Echo) {
+				string_view text = response.text;
+				while (text.size() > 0 and (text.back() == '\n' or text.back() == '\r')) {
+					text.remove_suffix(1);
+				}
+				Print("echo " + string(text));
+			}
+			else if (response.type == ResponseType::Temperature and !response.ok) {
+				//auto report, polled ones come from Exec
+				ostringstream out;
+				out<<"temperature hotend="<<response.hotend<<" bed="<<response.bed;
+				Print(out.str());
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	TtyPrinter printer;
+	SendMode mode = SendMode::PingPong;
+	int lines = 4;
+	int rxBuffer = 127;
+	int interval = 1000;
+	int wait = 2000;
+	int autoReport = 0;
+	bool verbose = false;
+	const char* logFile = nullptr;
+	int opt;
+	
+	while ((opt = getopt(argc, argv, "b:p:s:c:f:m:w:r:t:i:d:a:l:vh")) != -1) {
+		switch (opt) {
+			case 'b':
+				printer.m_baud = atoi(optarg);
+			break;
+			
+			case 'p':
+				printer.m_parity = optarg[0];
+			break;
+			
+			case 's':
+				printer.m_stopBits = atoi(optarg);
+			break;
+			
+			case 'c':
+				printer.m_dataBits = atoi(optarg);
+			break;
+			
+			case 'f':
+				printer.m_flow = optarg[0];
+			break;
+			
+			case 'm':
+				mode = (optarg[0] == 'w') ? SendMode::Window : SendMode::PingPong;
+			break;
+			
+			case 'w':
+				lines = atoi(optarg);
+			break;
+			
+			case 'r':
+				rxBuffer = atoi(optarg);
+			break;
+			
+			case 't':
+				printer.SetTimeout(atoi(optarg));
+			break;
+			
+			case 'i':
+				interval = atoi(optarg);
+			break;
+			
+			case 'd':
+				wait = atoi(optarg);
+			break;
+			
+			case 'a':
+				autoReport = atoi(optarg);
+			break;
+			
+			case 'v':
+				verbose = true;
+			break;
+			
+			case 'l':
+				logFile = optarg;
+			break;
+			
+			default:
+				cerr<<"usage: "<<argv[0]<<" [-b baud] [-p n|e|o] [-s stop bits] [-c data bits] [-f n|h|s]"
+					<<" [-m pingpong|window] [-w lines in flight] [-r rx buffer bytes]"
+					<<" [-t ok timeout ms] [-i progress ms] [-d wait after connect ms] [-a temperature report s] [-l log file] [-v] device file"<<endl;
+				return 1;
+		}
+	}
+	
+	if (argc - optind != 2) {
+		cerr<<"usage: "<<argv[0]<<" [options] device file"<<endl;
+		return 1;
+	}
+	
+	const char* device = argv[optind];
+	const char* filename = argv[optind + 1];
+	
+	//per line protocol traces are only wanted when asked for
+	if (!verbose) {
+		clog.setstate(ios::failbit);
+	}
+	
+	Logger::SetLevel(verbose ? LogLevel::Trace : LogLevel::Warning);
+	
+	//rotated at 16 MB, three old files kept
+	if (logFile and !Logger::SetFile(logFile, 16 * 1024 * 1024, 3)) {
+		cerr<<"Failed to open "<<logFile<<endl;
+		return 1;
+	}
+	
+	printer.SetMode(mode, lines, rxBuffer);
+	printer.SetAutoReport(autoReport);
+	
+	if (!printer.Open(filename)) {
+		cerr<<"Failed to open "<<filename<<endl;
+		return 1;
+	}
+	
+	if (!printer.Connect(device)) {
+		return 1;
+	}
+	
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+	
+	//most boards reset when the port is opened
+	this_thread::sleep_for(chrono::milliseconds(wait));
+	
+	Print("start file=" + string(filename) + " bytes=" + to_string(printer.Size()));
+	
+	if (!printer.Start()) {
+		Print("done status=no-response");
+		return 2;
+	}
+	
+	if (autoReport > 0) {
+		Print(string("auto-report ") + (printer.AutoReporting() ? "on" : "unsupported"));
+	}
+	
+	Clock::time_point start = Clock::now();
+	Clock::time_point report = start;
+	StepResult result = StepResult::Continue;
+	
+	auto Progress = [&](ostringstream& out, const char* what) {
+		double elapsed = chrono::duration<double>(Clock::now() - start).count();
+		double rate = (elapsed > 0.0) ? 1.0 / elapsed : 0.0;
+		size_t size = printer.Size();
+		
+		out<<what
+			<<" line="<<printer.CurrentLine()
+			<<" bytes="<<printer.Position()
+			<<" percent="<<((size > 0) ? 100.0 * printer.Position() / size : 100.0)
+			<<" elapsed="<<elapsed
+			<<" lines_per_s="<<printer.CurrentLine() * rate
+			<<" bytes_per_s="<<printer.Position() * rate
+			<<" resends="<<printer.Resends()
+			<<" latency_us="<<printer.Latency();
+	};
+	
+	while (!quit) {
+		result = printer.Step();
+		
+		if (result != StepResult::Continue) {
+			break;
+		}
+		
+		if (Clock::now() - report >= chrono::milliseconds(interval)) {
+			report = Clock::now();
+			
+			ostringstream out;
+			Progress(out, "progress");
+			Print(out.str());
+		}
+	}
+	
+	printer.Drain();
+	
+	ostringstream out;
+	Progress(out, "done");
+	out<<" status="<<StatusName(result);
+	if (result == StepResult::Lost) {
+		out<<" lost="<<printer.LostLine();
+	}
+	Print(out.str());
+	
+	return (result == StepResult::Ended) ? 0 : 2;
+}